@@ -4,15 +4,18 @@
 
 #include "cmCursesForm.h"
 #include "cmCursesMainForm.h"
+#include "cmCursesScreen.h"
 #include "cmCursesStandardIncludes.h"
 #include "cmDocumentation.h"
 #include "cmDocumentationEntry.h"
+#include "cmLogger.h"
+#include "cmState.h"
 #include "cmSystemTools.h"
+#include "cmTrace.h"
 #include "cmake.h"
 
 #include "cmsys/Encoding.hxx"
 #include <iostream>
-#include <signal.h>
 #include <string.h>
 #include <string>
 #include <vector>
@@ -37,31 +40,47 @@ static const char* cmDocumentationUsageNote[][2] = {
   { CM_NULLPTR, CM_NULLPTR }
 };
 
-static const char* cmDocumentationOptions[]
-                                         [2] = { CMAKE_STANDARD_OPTIONS_TABLE,
-                                                 { CM_NULLPTR, CM_NULLPTR } };
+static const char* cmDocumentationOptions[][2] = {
+  CMAKE_STANDARD_OPTIONS_TABLE,
+  { "-debug[=<level>]",
+    "Write a debug log to ccmakelog.txt.  Only records of at least the "
+    "given level (trace, debug, info, warning, error) are written; the "
+    "default is trace." },
+  { "-profile <file>",
+    "Write the time spent between configure messages to <file> on exit, "
+    "as JSON if the name ends in .json and as CSV otherwise." },
+  { "-metrics <file>",
+    "Write request counts, bytes received and latency histograms of the "
+    "cmake server requests, and the bytes written to the terminal, as "
+    "JSON to <file> on exit." },
+  { "-trace <file>",
+    "Record a timeline of server requests, cache loading, rendering and "
+    "key handling, and write it to <file> in the trace-event format used "
+    "by Perfetto and chrome://tracing." },
+  { CM_NULLPTR, CM_NULLPTR }
+};
 
 cmCursesForm* cmCursesForm::CurrentForm = CM_NULLPTR;
 
-extern "C" {
+// Stops the logger on every way out of main(), so that its writer
+// thread is joined before it is destroyed.
+struct LoggerGuard
+{
+  ~LoggerGuard() { cmLogger::Stop(); }
+};
 
-void onsig(int /*unused*/)
+// Writes the trace on every way out of main(), so that the file is
+// always a complete document.
+struct TraceGuard
 {
-  if (cmCursesForm::CurrentForm) {
-    endwin();
-    initscr();            /* Initialization */
-    noecho();             /* Echo off */
-    cbreak();             /* nl- or cr not needed */
-    keypad(stdscr, true); /* Use key symbols as KEY_DOWN */
-    refresh();
-    int x, y;
-    getmaxyx(stdscr, y, x);
-    cmCursesForm::CurrentForm->Render(1, 1, x, y);
-    cmCursesForm::CurrentForm->UpdateStatusBar();
+  std::string File;
+  ~TraceGuard()
+  {
+    if (!cmTrace::Stop()) {
+      std::cerr << "Could not write trace to " << this->File << ".\n";
+    }
   }
-  signal(SIGWINCH, onsig);
-}
-}
+};
 
 void CMakeMessageHandler(const char* message, const char* title,
                          bool& /*unused*/, void* clientData)
@@ -99,12 +118,29 @@ int main(int argc, char const* const* argv)
   }
 
   bool debug = false;
+  cmLogger::Level debugLevel = cmLogger::LevelTrace;
+  std::string profileFile;
+  std::string metricsFile;
+  std::string traceFile;
   unsigned int i;
   int j;
   std::vector<std::string> args;
   for (j = 0; j < argc; ++j) {
     if (strcmp(argv[j], "-debug") == 0) {
       debug = true;
+    } else if (strncmp(argv[j], "-debug=", 7) == 0) {
+      debug = true;
+      if (!cmLogger::ParseLevel(argv[j] + 7, debugLevel)) {
+        std::cerr << "Unknown debug level: " << (argv[j] + 7)
+                  << ". Use trace, debug, info, warning or error.\n";
+        return 1;
+      }
+    } else if (strcmp(argv[j], "-profile") == 0 && j + 1 < argc) {
+      profileFile = argv[++j];
+    } else if (strcmp(argv[j], "-metrics") == 0 && j + 1 < argc) {
+      metricsFile = argv[++j];
+    } else if (strcmp(argv[j], "-trace") == 0 && j + 1 < argc) {
+      traceFile = argv[++j];
     } else {
       args.push_back(argv[j]);
     }
@@ -120,8 +156,14 @@ int main(int argc, char const* const* argv)
 
   cmSystemTools::DisableRunCommandOutput();
 
+  LoggerGuard loggerGuard;
   if (debug) {
-    cmCursesForm::DebugStart();
+    cmLogger::Start("ccmakelog.txt", debugLevel);
+  }
+  TraceGuard traceGuard;
+  if (!traceFile.empty()) {
+    traceGuard.File = traceFile;
+    cmTrace::Start(traceFile);
   }
 
   initscr();            /* Initialization */
@@ -129,11 +171,12 @@ int main(int argc, char const* const* argv)
   cbreak();             /* nl- or cr not needed */
   keypad(stdscr, true); /* Use key symbols as KEY_DOWN */
 
-  signal(SIGWINCH, onsig);
+  cmCursesScreen::Start();
 
   int x, y;
   getmaxyx(stdscr, y, x);
   if (x < cmCursesMainForm::MIN_WIDTH || y < cmCursesMainForm::MIN_HEIGHT) {
+    cmCursesScreen::Stop();
     endwin();
     std::cerr << "Window is too small. A size of at least "
               << cmCursesMainForm::MIN_WIDTH << " x "
@@ -148,6 +191,7 @@ int main(int argc, char const* const* argv)
   if (myform->LoadCache(cacheDir.c_str())) {
     curses_clear();
     touchwin(stdscr);
+    cmCursesScreen::Stop();
     endwin();
     delete myform;
     std::cerr << "Error running cmake::LoadCache().  Aborting.\n";
@@ -158,7 +202,7 @@ int main(int argc, char const* const* argv)
 
   cmCursesForm::CurrentForm = myform;
 
-  myform->InitializeUI();
+  // Configure(1) creates the entries, without running cmake.
   if (myform->Configure(1) == 0) {
     myform->Render(1, 1, x, y);
     myform->HandleInput();
@@ -167,7 +211,23 @@ int main(int argc, char const* const* argv)
   // Need to clean-up better
   curses_clear();
   touchwin(stdscr);
+  cmCursesScreen::Stop();
   endwin();
+
+  if (!profileFile.empty() &&
+      !myform->GetCMakeInstance()->GetProfiler().Write(profileFile)) {
+    std::cerr << "Could not write profile to " << profileFile << ".\n";
+  }
+  cmSessionMetrics& metrics = myform->GetCMakeInstance()->GetMetrics();
+  metrics.GetTerminal().Updates = cmCursesScreen::GetNumberOfUpdates();
+  metrics.GetTerminal().BytesWritten = cmCursesScreen::GetBytesWritten();
+  cmState const* state = myform->GetCMakeInstance()->GetState();
+  metrics.GetCache().Entries = state->GetNumberOfCacheEntries();
+  metrics.GetCache().Strings = state->GetStringPool()->GetNumberOfStrings();
+  metrics.GetCache().PoolBytes = state->GetStringPool()->GetAllocatedBytes();
+  if (!metricsFile.empty() && !metrics.Write(metricsFile)) {
+    std::cerr << "Could not write metrics to " << metricsFile << ".\n";
+  }
   delete cmCursesForm::CurrentForm;
   cmCursesForm::CurrentForm = CM_NULLPTR;
 
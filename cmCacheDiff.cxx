@@ -0,0 +1,298 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmCacheDiff.h"
+
+#include <algorithm>
+#include <map>
+
+#include "cmSystemTools.h"
+#include "cmsys/FStream.hxx"
+
+namespace {
+
+bool key_less(
+  cmCacheDiff::EntryList::value_type const& lhs,
+  cmCacheDiff::EntryList::value_type const& rhs)
+{
+  return lhs.first < rhs.first;
+}
+
+unsigned int compare_entries(
+  cmState::CacheEntry const& lhs, cmState::CacheEntry const& rhs)
+{
+  unsigned int fields = 0;
+  if (lhs.Value != rhs.Value) {
+    fields |= cmCacheDiff::ValueChanged;
+  }
+  if (lhs.Type != rhs.Type) {
+    fields |= cmCacheDiff::TypeChanged;
+  }
+  if (lhs.HelpString != rhs.HelpString) {
+    fields |= cmCacheDiff::HelpStringChanged;
+  }
+  if (lhs.Strings != rhs.Strings) {
+    fields |= cmCacheDiff::StringsChanged;
+  }
+  if (lhs.IsAdvanced != rhs.IsAdvanced) {
+    fields |= cmCacheDiff::AdvancedChanged;
+  }
+  return fields;
+}
+
+// Split a "KEY:TYPE=VALUE" line the way cmCacheManager does.
+bool parse_entry(
+  std::string const& line, std::string& key, std::string& type,
+  std::string& value)
+{
+  std::string::size_type keyEnd;
+  std::string::size_type typeBegin;
+  if (line[0] == '"') {
+    keyEnd = line.find('"', 1);
+    if (keyEnd == std::string::npos || keyEnd + 1 >= line.size() ||
+        line[keyEnd + 1] != ':') {
+      return false;
+    }
+    key = line.substr(1, keyEnd - 1);
+    typeBegin = keyEnd + 2;
+  } else {
+    keyEnd = line.find(':');
+    if (keyEnd == std::string::npos) {
+      return false;
+    }
+    key = line.substr(0, keyEnd);
+    typeBegin = keyEnd + 1;
+  }
+  auto const eq = line.find('=', typeBegin);
+  if (eq == std::string::npos) {
+    return false;
+  }
+  type = line.substr(typeBegin, eq - typeBegin);
+  value = line.substr(eq + 1);
+  return true;
+}
+
+bool strip_suffix(std::string& key, const char* suffix)
+{
+  std::string::size_type const len = std::char_traits<char>::length(suffix);
+  if (key.size() <= len || key.compare(key.size() - len, len, suffix) != 0) {
+    return false;
+  }
+  key.erase(key.size() - len);
+  return true;
+}
+
+void append_quoted(std::string& out, std::string const& value)
+{
+  out += '"';
+  out += value;
+  out += '"';
+}
+
+} // namespace
+
+cmCacheDiff::EntryList cmCacheDiff::ListEntries(cmState const& state)
+{
+  EntryList entries;
+  entries.reserve(state.GetNumberOfCacheEntries() +
+                  state.GetNumberOfHiddenCacheEntries());
+  auto const byKey = [](EntryList::value_type const& lhs,
+                        EntryList::value_type const& rhs) {
+    return lhs.first < rhs.first;
+  };
+  for (cmState::EntryId id = 0; id < state.GetNumberOfCacheEntries(); ++id) {
+    if (state.GetCacheEntryFlag(id, cmState::FlagRemoved)) {
+      continue;
+    }
+    entries.emplace_back(state.GetCacheEntryKey(id), state.GetCacheEntry(id));
+  }
+  if (!std::is_sorted(entries.begin(), entries.end(), byKey)) {
+    std::sort(entries.begin(), entries.end(), byKey);
+  }
+
+  // Hidden entries are sorted already.
+  std::size_t const middle = entries.size();
+  for (std::size_t i = 0; i < state.GetNumberOfHiddenCacheEntries(); ++i) {
+    entries.emplace_back(
+      state.GetHiddenCacheEntryKey(i), state.GetHiddenCacheEntry(i));
+  }
+  std::inplace_merge(
+    entries.begin(), entries.begin() + middle, entries.end(), byKey);
+  return entries;
+}
+
+bool cmCacheDiff::LoadCacheFile(
+  std::string const& buildDir, EntryList& entries)
+{
+  entries.clear();
+
+  cmsys::ifstream fin((buildDir + "/CMakeCache.txt").c_str());
+  if (!fin) {
+    return false;
+  }
+
+  std::map<std::string, cmState::CacheEntry> cache;
+  std::vector<std::pair<std::string, std::string>> advanced;
+  std::vector<std::pair<std::string, std::string>> strings;
+
+  std::string help;
+  std::string line;
+  std::string key;
+  std::string type;
+  std::string value;
+  while (std::getline(fin, line)) {
+    if (!line.empty() && line[line.size() - 1] == '\r') {
+      line.erase(line.size() - 1);
+    }
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    // Long help strings are wrapped over several comment lines.
+    if (line.compare(0, 2, "//") == 0) {
+      if (line.compare(2, 2, "\\n") == 0) {
+        help += '\n';
+        help.append(line, 4, std::string::npos);
+      } else {
+        help.append(line, 2, std::string::npos);
+      }
+      continue;
+    }
+    if (!parse_entry(line, key, type, value)) {
+      help.clear();
+      continue;
+    }
+
+    // Properties are stored as INTERNAL entries named after their owner.
+    auto const entryType = cmState::StringToCacheEntryType(type);
+    if (entryType == cmStateEnums::INTERNAL) {
+      if (strip_suffix(key, "-ADVANCED")) {
+        advanced.emplace_back(std::move(key), std::move(value));
+        help.clear();
+        continue;
+      }
+      if (strip_suffix(key, "-STRINGS")) {
+        strings.emplace_back(std::move(key), std::move(value));
+        help.clear();
+        continue;
+      }
+    }
+
+    auto& entry = cache[key];
+    entry.Type = entryType;
+    entry.Value = value;
+    entry.HelpString.swap(help);
+    help.clear();
+  }
+
+  // Property lines come after the entries they belong to.
+  for (auto const& prop : advanced) {
+    auto const i = cache.find(prop.first);
+    if (i != cache.end()) {
+      i->second.IsAdvanced = cmSystemTools::IsOn(prop.second);
+    }
+  }
+  for (auto const& prop : strings) {
+    auto const i = cache.find(prop.first);
+    if (i != cache.end()) {
+      i->second.Strings = prop.second;
+    }
+  }
+
+  entries.assign(cache.begin(), cache.end());
+  return true;
+}
+
+std::vector<cmCacheDiff::Change> cmCacheDiff::Compute(
+  EntryList const& from, EntryList const& to)
+{
+  std::vector<Change> changes;
+
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < from.size() || j < to.size()) {
+    if (j == to.size() || (i < from.size() && key_less(from[i], to[j]))) {
+      changes.push_back(Change{ Removed, 0, i, npos });
+      ++i;
+    } else if (i == from.size() || key_less(to[j], from[i])) {
+      changes.push_back(Change{ Added, 0, npos, j });
+      ++j;
+    } else {
+      unsigned int const fields =
+        compare_entries(from[i].second, to[j].second);
+      if (fields != 0) {
+        changes.push_back(Change{ Changed, fields, i, j });
+      }
+      ++i;
+      ++j;
+    }
+  }
+
+  return changes;
+}
+
+std::string cmCacheDiff::Format(
+  std::vector<Change> const& changes, EntryList const& from,
+  EntryList const& to)
+{
+  std::string out;
+  if (changes.empty()) {
+    out = "No differences.\n";
+    return out;
+  }
+
+  for (Change const& change : changes) {
+    if (change.Kind == Added) {
+      auto const& entry = to[change.To];
+      out += "+ ";
+      out += entry.first;
+      out += ':';
+      out += cmState::CacheEntryTypeToString(entry.second.Type);
+      out += '=';
+      out += entry.second.Value;
+      out += '\n';
+      continue;
+    }
+    if (change.Kind == Removed) {
+      out += "- ";
+      out += from[change.From].first;
+      out += '\n';
+      continue;
+    }
+
+    auto const& oldEntry = from[change.From].second;
+    auto const& newEntry = to[change.To].second;
+    std::string const& key = to[change.To].first;
+    if (change.Fields & ValueChanged) {
+      out += "~ " + key + ": ";
+      append_quoted(out, oldEntry.Value);
+      out += " -> ";
+      append_quoted(out, newEntry.Value);
+      out += '\n';
+    }
+    if (change.Fields & TypeChanged) {
+      out += "~ " + key + " type: ";
+      out += cmState::CacheEntryTypeToString(oldEntry.Type);
+      out += " -> ";
+      out += cmState::CacheEntryTypeToString(newEntry.Type);
+      out += '\n';
+    }
+    if (change.Fields & HelpStringChanged) {
+      out += "~ " + key + " HELPSTRING: ";
+      append_quoted(out, newEntry.HelpString);
+      out += '\n';
+    }
+    if (change.Fields & StringsChanged) {
+      out += "~ " + key + " STRINGS: ";
+      append_quoted(out, oldEntry.Strings);
+      out += " -> ";
+      append_quoted(out, newEntry.Strings);
+      out += '\n';
+    }
+    if (change.Fields & AdvancedChanged) {
+      out += "~ " + key + " ADVANCED: ";
+      out += newEntry.IsAdvanced ? "ON" : "OFF";
+      out += '\n';
+    }
+  }
+  return out;
+}
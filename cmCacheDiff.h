@@ -0,0 +1,68 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmCacheDiff_h
+#define cmCacheDiff_h
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cmState.h"
+
+/** \class cmCacheDiff
+ * \brief Compare two lists of cache entries.
+ *
+ * An entry list is a copy of the cache entries sorted by key, without
+ * the ones flagged for removal.  Comparing two lists is a single merge
+ * pass over both of them.
+ */
+class cmCacheDiff
+{
+public:
+  typedef std::vector<std::pair<std::string, cmState::CacheEntry>>
+    EntryList;
+
+  enum ChangeKind
+  {
+    Added,
+    Removed,
+    Changed
+  };
+
+  enum ChangedField
+  {
+    ValueChanged = 1 << 0,
+    TypeChanged = 1 << 1,
+    HelpStringChanged = 1 << 2,
+    StringsChanged = 1 << 3,
+    AdvancedChanged = 1 << 4
+  };
+
+  // Indices into the compared lists; npos where there is no entry.
+  struct Change
+  {
+    ChangeKind Kind;
+    unsigned int Fields;
+    std::size_t From;
+    std::size_t To;
+  };
+
+  static std::size_t const npos = static_cast<std::size_t>(-1);
+
+  static EntryList ListEntries(cmState const& state);
+
+  // Read <buildDir>/CMakeCache.txt into an entry list.
+  static bool LoadCacheFile(std::string const& buildDir, EntryList& entries);
+
+  static std::vector<Change> Compute(
+    EntryList const& from, EntryList const& to);
+
+  // Human readable report, one line per added or removed entry and one
+  // line per changed field.
+  static std::string Format(
+    std::vector<Change> const& changes, EntryList const& from,
+    EntryList const& to);
+};
+
+#endif
@@ -0,0 +1,216 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmCacheSearch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "cmTrigramIndex.h"
+
+namespace {
+
+// Longer words are cut, so that counts of trigrams fit in a byte.
+const std::size_t MaxWordLength = 64;
+
+// Share of the trigrams of the words that candidates have on average,
+// and that a word must have in an entry to count as found with typos.
+const float CandidateShare = 0.6f;
+const double FuzzyShare = 0.7;
+
+// Sorted.
+const char* const stop_words[] = { "a",    "about", "an",    "and",   "are",
+                                   "be",   "by",    "can",   "do",    "does",
+                                   "for",  "from",  "how",   "i",     "in",
+                                   "is",   "it",    "of",    "on",    "or",
+                                   "that", "the",   "this",  "to",    "what",
+                                   "when", "where", "which", "who",   "why",
+                                   "with" };
+
+bool is_stop_word(std::string const& word)
+{
+  const char* const* end =
+    stop_words + sizeof(stop_words) / sizeof(*stop_words);
+  return std::binary_search(
+    stop_words, end, word.c_str(),
+    [](const char* lhs, const char* rhs) { return strcmp(lhs, rhs) < 0; });
+}
+
+// Where the word occurs in the text, ignoring case: -1 if it does not,
+// otherwise the position.  The word is in lower case.
+long find_folded(const char* text, std::string const& word)
+{
+  if (!text) {
+    return -1;
+  }
+  // Candidates for the first character are found with memchr, in
+  // either case.
+  int const lower = static_cast<unsigned char>(word[0]);
+  int const upper = lower >= 'a' && lower <= 'z' ? lower - 'a' + 'A' : lower;
+  std::size_t const length = word.size();
+  const char* const end = text + strlen(text);
+  for (const char* c = text; static_cast<std::size_t>(end - c) >= length;
+       ++c) {
+    const char* next = static_cast<const char*>(memchr(c, lower, end - c));
+    if (upper != lower) {
+      const char* const other = static_cast<const char*>(
+        memchr(c, upper, (next ? next : end) - c));
+      if (other) {
+        next = other;
+      }
+    }
+    if (!next || static_cast<std::size_t>(end - next) < length) {
+      return -1;
+    }
+    c = next;
+    std::size_t i = 1;
+    while (i < length &&
+           (c[i] == word[i] ||
+            (c[i] >= 'A' && c[i] <= 'Z' && c[i] - 'A' + 'a' == word[i]))) {
+      ++i;
+    }
+    if (i == length) {
+      return static_cast<long>(c - text);
+    }
+  }
+  return -1;
+}
+
+// Whether a word of the key starts at the position.
+bool starts_word(const char* key, long pos)
+{
+  return pos == 0 || cmTrigramIndex::Fold(key[pos - 1]) < 0;
+}
+
+struct Word
+{
+  std::string Text;
+  std::vector<cmTrigramIndex::Trigram> Trigrams; // distinct
+  std::vector<std::uint8_t> Hits; // trigrams found, by entry
+  double Weight;
+};
+}
+
+std::vector<std::string> cmCacheSearch::GetWords(std::string const& query)
+{
+  std::vector<std::string> words;
+  std::string word;
+  for (std::string::size_type i = 0; i <= query.size(); ++i) {
+    int const folded =
+      i < query.size() ? cmTrigramIndex::Fold(query[i]) : -1;
+    if (folded >= 0) {
+      if (word.size() < MaxWordLength) {
+        word += static_cast<char>(folded < 10 ? '0' + folded
+                                              : 'a' + folded - 10);
+      }
+      continue;
+    }
+    if (!word.empty() && !is_stop_word(word) &&
+        std::find(words.begin(), words.end(), word) == words.end()) {
+      words.push_back(word);
+    }
+    word.clear();
+  }
+  return words;
+}
+
+std::vector<cmCacheSearch::Match> cmCacheSearch::Find(
+  cmState const& state, std::string const& query)
+{
+  std::vector<Match> matches;
+  std::vector<std::string> const texts = GetWords(query);
+  if (texts.empty()) {
+    return matches;
+  }
+  cmTrigramIndex const& index = state.GetWordIndex();
+  std::size_t const count = state.GetNumberOfCacheEntries();
+
+  // Count the trigrams of every word in every entry.  Words shorter
+  // than a trigram are only checked against the candidates.
+  std::vector<Word> words(texts.size());
+  std::vector<float> coverage(count, 0.0f);
+  std::size_t indexed = 0;
+  for (std::size_t w = 0; w < texts.size(); ++w) {
+    Word& word = words[w];
+    word.Text = texts[w];
+    word.Weight = 1.0;
+    if (word.Text.size() < 3) {
+      continue;
+    }
+    ++indexed;
+    for (std::size_t i = 0; i + 3 <= word.Text.size(); ++i) {
+      word.Trigrams.push_back(cmTrigramIndex::Encode(&word.Text[i]));
+    }
+    std::sort(word.Trigrams.begin(), word.Trigrams.end());
+    word.Trigrams.erase(
+      std::unique(word.Trigrams.begin(), word.Trigrams.end()),
+      word.Trigrams.end());
+    word.Hits.assign(count, 0);
+    std::uint8_t* hits = word.Hits.data();
+    for (cmTrigramIndex::Trigram trigram : word.Trigrams) {
+      for (cmTrigramIndex::Id id : index.Find(trigram)) {
+        if (id < count) {
+          ++hits[id];
+        }
+      }
+    }
+    // Dense loops over bytes, which compilers vectorize.
+    std::uint8_t const all = static_cast<std::uint8_t>(word.Trigrams.size());
+    float const share = 1.0f / all;
+    std::size_t containing = 0;
+    for (std::size_t id = 0; id < count; ++id) {
+      coverage[id] += hits[id] * share;
+      containing += hits[id] == all;
+    }
+    // Rare words tell more about what is looked for.
+    word.Weight = std::log(1.0 + static_cast<double>(count) /
+                             static_cast<double>(1 + containing));
+  }
+
+  // An entry is a candidate if it has enough of the trigrams of the
+  // indexed words on average.  Without such words, all are.
+  std::vector<cmState::EntryId> candidates;
+  float const threshold = CandidateShare * static_cast<float>(indexed);
+  for (std::size_t id = 0; id < count; ++id) {
+    if (coverage[id] >= threshold) {
+      candidates.push_back(static_cast<cmState::EntryId>(id));
+    }
+  }
+
+  for (cmState::EntryId id : candidates) {
+    const char* key = state.GetCacheEntryKey(id);
+    const char* value = state.GetCacheEntryValue(id);
+    const char* help =
+      state.GetCacheEntryProperty(id, cmStateEnums::HELPSTRING);
+    double score = 0;
+    for (Word const& word : words) {
+      long const pos = find_folded(key, word.Text);
+      double found = 0;
+      if (pos >= 0) {
+        found = starts_word(key, pos) ? 4 : 3;
+      } else if (find_folded(value, word.Text) >= 0) {
+        found = 2;
+      } else if (find_folded(help, word.Text) >= 0) {
+        found = 1.5;
+      } else if (!word.Trigrams.empty()) {
+        double const share = static_cast<double>(word.Hits[id]) /
+          static_cast<double>(word.Trigrams.size());
+        if (share >= FuzzyShare) {
+          found = share * share;
+        }
+      }
+      score += word.Weight * found;
+    }
+    if (score > 0) {
+      Match const match = { id, score };
+      matches.push_back(match);
+    }
+  }
+  std::stable_sort(matches.begin(), matches.end(),
+                   [](Match const& lhs, Match const& rhs) {
+                     return lhs.Score > rhs.Score;
+                   });
+  return matches;
+}
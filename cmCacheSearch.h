@@ -0,0 +1,46 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmCacheSearch_h
+#define cmCacheSearch_h
+
+#include <string>
+#include <vector>
+
+#include "cmState.h"
+
+/** \class cmCacheSearch
+ * \brief Rank cache entries by how well they match the words of a query.
+ *
+ * The words of the query, less common English ones like "where" or
+ * "the", are looked up in the trigram index of the state.  For every
+ * word, the number of its trigrams found in each entry is counted in a
+ * dense array, so that selecting the candidates is a plain pass over
+ * small integers.  Entries that contain most of the trigrams of the
+ * words on average are candidates.
+ *
+ * Candidates are scored against their actual text: a word found in the
+ * key counts most, more so at the start of a part of the key, then a
+ * word found in the value and then in the help string.  A word that is
+ * not found as a whole counts by the share of its trigrams that the
+ * entry contains, which tolerates typos and inflections.  Words that
+ * few entries contain weigh more.
+ */
+class cmCacheSearch
+{
+public:
+  struct Match
+  {
+    cmState::EntryId Id;
+    double Score;
+  };
+
+  // Entries that match the query, best first.  Entries with the same
+  // score keep the order of their ids.
+  static std::vector<Match> Find(cmState const& state,
+                                 std::string const& query);
+
+  // The words of the query that are searched, in lower case.
+  static std::vector<std::string> GetWords(std::string const& query);
+};
+
+#endif
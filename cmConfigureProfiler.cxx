@@ -0,0 +1,207 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmConfigureProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#include <json/value.h>
+#include <json/writer.h>
+
+#include "cmSystemTools.h"
+#include "cmsys/FStream.hxx"
+
+namespace {
+
+std::string const start_label = "(before the first message)";
+
+double to_ms(std::uint64_t ns)
+{
+  return static_cast<double>(ns) / 1e6;
+}
+
+bool longer(
+  cmConfigureProfiler::Interval const& lhs,
+  cmConfigureProfiler::Interval const& rhs)
+{
+  return lhs.Duration > rhs.Duration;
+}
+
+void write_csv_field(std::ostream& os, std::string const& str)
+{
+  os << '"';
+  for (char c : str) {
+    if (c == '"') {
+      os << '"';
+    }
+    os << c;
+  }
+  os << '"';
+}
+
+} // namespace
+
+void cmConfigureProfiler::Start(std::string const& request, std::uint64_t time)
+{
+  this->Runs.emplace_back();
+  this->Runs.back().Request = request;
+  this->Runs.back().Begin = time;
+  this->Running = true;
+}
+
+void cmConfigureProfiler::Finish(std::uint64_t time)
+{
+  if (!this->Running) {
+    return;
+  }
+  this->Runs.back().End = time;
+  this->Running = false;
+}
+
+void cmConfigureProfiler::AddMessage(
+  std::uint64_t time, std::string const& text)
+{
+  if (!this->Running) {
+    return;
+  }
+  this->Runs.back().Events.push_back(Event{ time, false, 0.f, text });
+}
+
+void cmConfigureProfiler::AddProgress(std::uint64_t time, float progress)
+{
+  if (!this->Running) {
+    return;
+  }
+  this->Runs.back().Events.push_back(
+    Event{ time, true, progress, std::string() });
+}
+
+void cmConfigureProfiler::AddIntervals(
+  std::size_t run, std::vector<Interval>& out) const
+{
+  Run const& r = this->Runs[run];
+  std::uint64_t begin = r.Begin;
+  std::string const* text = &start_label;
+  for (Event const& event : r.Events) {
+    if (event.IsProgress) {
+      continue;
+    }
+    out.push_back(Interval{ run, begin, event.Time - begin, text });
+    begin = event.Time;
+    text = &event.Text;
+  }
+  out.push_back(Interval{ run, begin, r.End - begin, text });
+}
+
+std::vector<cmConfigureProfiler::Interval> cmConfigureProfiler::GetIntervals()
+  const
+{
+  std::vector<Interval> intervals;
+  std::size_t const finished = this->Runs.size() - (this->Running ? 1 : 0);
+  for (std::size_t run = 0; run < finished; ++run) {
+    this->AddIntervals(run, intervals);
+  }
+  std::stable_sort(intervals.begin(), intervals.end(), longer);
+  return intervals;
+}
+
+std::string cmConfigureProfiler::Report() const
+{
+  std::size_t const finished = this->Runs.size() - (this->Running ? 1 : 0);
+  if (finished == 0) {
+    return "No configure step has been profiled yet.";
+  }
+
+  std::size_t const last = finished - 1;
+  Run const& run = this->Runs[last];
+  std::vector<Interval> intervals;
+  this->AddIntervals(last, intervals);
+  std::stable_sort(intervals.begin(), intervals.end(), longer);
+
+  double const total = to_ms(run.End - run.Begin);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "Last " << run.Request << " took " << total / 1000 << " s, "
+     << intervals.size() - 1 << " messages.\n\n"
+     << "Time until the next message, slowest first:\n";
+  for (Interval const& interval : intervals) {
+    double const ms = to_ms(interval.Duration);
+    os << std::setw(10) << ms / 1000 << " s " << std::setw(6)
+       << std::setprecision(1) << (total > 0 ? 100 * ms / total : 0.)
+       << "%  " << std::setprecision(3) << *interval.Text << '\n';
+  }
+  return os.str();
+}
+
+bool cmConfigureProfiler::Write(std::string const& file) const
+{
+  cmsys::ofstream fout(file.c_str());
+  if (!fout) {
+    return false;
+  }
+  std::string const ext =
+    cmSystemTools::LowerCase(cmSystemTools::GetFilenameLastExtension(file));
+  if (ext == ".json") {
+    this->WriteJSON(fout);
+  } else {
+    this->WriteCSV(fout);
+  }
+  return static_cast<bool>(fout);
+}
+
+void cmConfigureProfiler::WriteCSV(std::ostream& os) const
+{
+  os << "run,request,start_ms,duration_ms,message\n";
+  os << std::fixed << std::setprecision(3);
+  for (Interval const& interval : this->GetIntervals()) {
+    Run const& run = this->Runs[interval.Run];
+    os << interval.Run << ',' << run.Request << ','
+       << to_ms(interval.Begin - run.Begin) << ','
+       << to_ms(interval.Duration) << ',';
+    write_csv_field(os, *interval.Text);
+    os << '\n';
+  }
+}
+
+void cmConfigureProfiler::WriteJSON(std::ostream& os) const
+{
+  std::vector<Interval> const intervals = this->GetIntervals();
+
+  Json::Value runs = Json::arrayValue;
+  std::size_t const finished = this->Runs.size() - (this->Running ? 1 : 0);
+  for (std::size_t i = 0; i < finished; ++i) {
+    Run const& run = this->Runs[i];
+    Json::Value value = Json::objectValue;
+    value["request"] = run.Request;
+    value["duration_ms"] = to_ms(run.End - run.Begin);
+    value["intervals"] = Json::arrayValue;
+    value["progress"] = Json::arrayValue;
+    for (Event const& event : run.Events) {
+      if (event.IsProgress) {
+        Json::Value progress = Json::objectValue;
+        progress["time_ms"] = to_ms(event.Time - run.Begin);
+        progress["progress"] = event.Progress;
+        value["progress"].append(progress);
+      }
+    }
+    runs.append(value);
+  }
+
+  for (Interval const& interval : intervals) {
+    Run const& run = this->Runs[interval.Run];
+    Json::Value value = Json::objectValue;
+    value["start_ms"] = to_ms(interval.Begin - run.Begin);
+    value["duration_ms"] = to_ms(interval.Duration);
+    value["message"] = *interval.Text;
+    runs[static_cast<Json::ArrayIndex>(interval.Run)]["intervals"].append(
+      value);
+  }
+
+  Json::Value root = Json::objectValue;
+  root["runs"] = runs;
+  Json::StyledStreamWriter writer;
+  writer.write(os, root);
+}
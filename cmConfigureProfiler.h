@@ -0,0 +1,73 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmConfigureProfiler_h
+#define cmConfigureProfiler_h
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/** \class cmConfigureProfiler
+ * \brief Attribute the wall time of a server request to its messages.
+ *
+ * Every message and progress packet is recorded with the time it
+ * arrived.  The time between two messages is charged to the first of
+ * them, which is how "-- Looking for ..." checks report their cost.
+ */
+class cmConfigureProfiler
+{
+public:
+  struct Event
+  {
+    std::uint64_t Time; // nanoseconds, uv_hrtime()
+    bool IsProgress;
+    float Progress;
+    std::string Text;
+  };
+
+  struct Run
+  {
+    std::string Request;
+    std::uint64_t Begin = 0;
+    std::uint64_t End = 0;
+    std::vector<Event> Events;
+  };
+
+  struct Interval
+  {
+    std::size_t Run;
+    std::uint64_t Begin;
+    std::uint64_t Duration;
+    std::string const* Text;
+  };
+
+  void Start(std::string const& request, std::uint64_t time);
+  void Finish(std::uint64_t time);
+  bool IsRunning() const { return this->Running; }
+
+  void AddMessage(std::uint64_t time, std::string const& text);
+  void AddProgress(std::uint64_t time, float progress);
+
+  std::vector<Run> const& GetRuns() const { return this->Runs; }
+
+  // Intervals between the messages of all finished runs, longest first.
+  std::vector<Interval> GetIntervals() const;
+
+  // Summary of the last finished run for display.
+  std::string Report() const;
+
+  // Write all intervals; the format is chosen by the file extension
+  // (.json or .csv).
+  bool Write(std::string const& file) const;
+  void WriteCSV(std::ostream& os) const;
+  void WriteJSON(std::ostream& os) const;
+
+private:
+  void AddIntervals(std::size_t run, std::vector<Interval>& out) const;
+
+  std::vector<Run> Runs;
+  bool Running = false;
+};
+
+#endif
@@ -19,7 +19,7 @@ cmCursesBoolWidget::cmCursesBoolWidget(int width, int height, int left,
 }
 
 bool cmCursesBoolWidget::HandleInput(int& key, cmCursesMainForm* /*fm*/,
-                                     WINDOW* w)
+                                     WINDOW* /*w*/)
 {
 
   // toggle boolean values with enter or space
@@ -30,9 +30,6 @@ bool cmCursesBoolWidget::HandleInput(int& key, cmCursesMainForm* /*fm*/,
     } else {
       this->SetValueAsBool(true);
     }
-
-    touchwin(w);
-    wrefresh(w);
     return true;
   }
   return false;
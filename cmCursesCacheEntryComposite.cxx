@@ -15,11 +15,12 @@
 #include "cmake.h"
 
 #include <assert.h>
-#include <vector>
 
-cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(
-  const std::string& key, int labelwidth, int entrywidth)
+cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(const char* key,
+                                                         int labelwidth,
+                                                         int entrywidth)
   : Key(key)
+  , Id(cmState::InvalidEntry)
   , LabelWidth(labelwidth)
   , EntryWidth(entrywidth)
 {
@@ -30,13 +31,14 @@ cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(
 }
 
 cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(
-  const std::string& key, cmake* cm, bool isNew, int labelwidth,
-  int entrywidth)
-  : Key(key)
+  cmState::EntryId id, cmake* cm, bool isNew, int labelwidth, int entrywidth)
+  : Key(cm->GetState()->GetCacheEntryKey(id))
+  , Id(id)
   , LabelWidth(labelwidth)
   , EntryWidth(entrywidth)
 {
-  this->Label = new cmCursesLabelWidget(this->LabelWidth, 1, 1, 1, key);
+  this->Label =
+    new cmCursesLabelWidget(this->LabelWidth, 1, 1, 1, this->Key);
   if (isNew) {
     this->IsNewLabel = new cmCursesLabelWidget(1, 1, 1, 1, "*");
   } else {
@@ -44,16 +46,14 @@ cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(
   }
 
   this->Entry = CM_NULLPTR;
-  const char* value = cm->GetState()->GetCacheEntryValue(key);
+  cmState const* state = cm->GetState();
+  const char* value = state->GetCacheEntryValue(id);
   assert(value);
-  switch (cm->GetState()->GetCacheEntryType(key)) {
+  switch (state->GetCacheEntryType(id)) {
     case cmStateEnums::BOOL:
       this->Entry = new cmCursesBoolWidget(this->EntryWidth, 1, 1, 1);
-      if (cmSystemTools::IsOn(value)) {
-        static_cast<cmCursesBoolWidget*>(this->Entry)->SetValueAsBool(true);
-      } else {
-        static_cast<cmCursesBoolWidget*>(this->Entry)->SetValueAsBool(false);
-      }
+      static_cast<cmCursesBoolWidget*>(this->Entry)
+        ->SetValueAsBool(state->GetCacheEntryValueAsBool(id));
       break;
     case cmStateEnums::PATH:
       this->Entry = new cmCursesPathWidget(this->EntryWidth, 1, 1, 1);
@@ -64,17 +64,14 @@ cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(
       static_cast<cmCursesFilePathWidget*>(this->Entry)->SetString(value);
       break;
     case cmStateEnums::STRING: {
-      const char* stringsProp =
-        cm->GetState()->GetCacheEntryProperty(key, "STRINGS");
-      if (stringsProp) {
+      if (state->GetCacheEntryProperty(id, cmStateEnums::STRINGS)) {
         cmCursesOptionsWidget* ow =
           new cmCursesOptionsWidget(this->EntryWidth, 1, 1, 1);
         this->Entry = ow;
-        std::vector<std::string> options;
-        cmSystemTools::ExpandListArgument(stringsProp, options);
-        for (std::vector<std::string>::iterator si = options.begin();
-             si != options.end(); ++si) {
-          ow->AddOption(*si);
+        std::size_t const numberOfOptions =
+          state->GetCacheEntryNumberOfStrings(id);
+        for (std::size_t i = 0; i < numberOfOptions; ++i) {
+          ow->AddOption(state->GetCacheEntryString(id, i));
         }
         ow->SetOption(value);
       } else {
@@ -84,7 +81,8 @@ cmCursesCacheEntryComposite::cmCursesCacheEntryComposite(
       break;
     }
     case cmStateEnums::UNINITIALIZED:
-      cmSystemTools::Error("Found an undefined variable: ", key.c_str());
+      cmSystemTools::Error("Found an undefined variable: ",
+                          this->Key);
       break;
     default:
       // TODO : put warning message here
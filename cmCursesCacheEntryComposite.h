@@ -7,6 +7,8 @@
 
 #include <string>
 
+#include "cmState.h"
+
 class cmCursesLabelWidget;
 class cmCursesWidget;
 class cmake;
@@ -16,9 +18,9 @@ class cmCursesCacheEntryComposite
   CM_DISABLE_COPY(cmCursesCacheEntryComposite)
 
 public:
-  cmCursesCacheEntryComposite(const std::string& key, int labelwidth,
+  cmCursesCacheEntryComposite(const char* key, int labelwidth,
                               int entrywidth);
-  cmCursesCacheEntryComposite(const std::string& key, cmake* cm, bool isNew,
+  cmCursesCacheEntryComposite(cmState::EntryId id, cmake* cm, bool isNew,
                               int labelwidth, int entrywidth);
   ~cmCursesCacheEntryComposite();
   const char* GetValue();
@@ -29,7 +31,8 @@ protected:
   cmCursesLabelWidget* Label;
   cmCursesLabelWidget* IsNewLabel;
   cmCursesWidget* Entry;
-  std::string Key;
+  const char* Key; // owned by the string pool of the state
+  cmState::EntryId Id;
   int LabelWidth;
   int EntryWidth;
 };
@@ -2,9 +2,6 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCursesForm.h"
 
-cmsys::ofstream cmCursesForm::DebugFile;
-bool cmCursesForm::Debug = false;
-
 cmCursesForm::cmCursesForm()
 {
   this->Form = CM_NULLPTR;
@@ -18,28 +15,3 @@ cmCursesForm::~cmCursesForm()
     this->Form = CM_NULLPTR;
   }
 }
-
-void cmCursesForm::DebugStart()
-{
-  cmCursesForm::Debug = true;
-  cmCursesForm::DebugFile.open("ccmakelog.txt");
-}
-
-void cmCursesForm::DebugEnd()
-{
-  if (!cmCursesForm::Debug) {
-    return;
-  }
-
-  cmCursesForm::Debug = false;
-  cmCursesForm::DebugFile.close();
-}
-
-void cmCursesForm::LogMessage(const char* msg)
-{
-  if (!cmCursesForm::Debug) {
-    return;
-  }
-
-  cmCursesForm::DebugFile << msg << std::endl;
-}
@@ -7,8 +7,6 @@
 
 #include "cmCursesStandardIncludes.h"
 
-#include "cmsys/FStream.hxx"
-
 class cmCursesForm
 {
   CM_DISABLE_COPY(cmCursesForm)
@@ -35,18 +33,6 @@ public:
   // to be displayed afterwards.
   virtual void AddError(const char*, const char*) {}
 
-  // Description:
-  // Turn debugging on. This will create ccmakelog.txt.
-  static void DebugStart();
-
-  // Description:
-  // Turn debugging off. This will close ccmakelog.txt.
-  static void DebugEnd();
-
-  // Description:
-  // Write a debugging message.
-  static void LogMessage(const char* msg);
-
   // Description:
   // Return the FORM. Should be only used by low-level methods.
   FORM* GetForm() { return this->Form; }
@@ -54,9 +40,6 @@ public:
   static cmCursesForm* CurrentForm;
 
 protected:
-  static cmsys::ofstream DebugFile;
-  static bool Debug;
-
   FORM* Form;
 };
 
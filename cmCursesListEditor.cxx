@@ -0,0 +1,349 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCursesListEditor.h"
+
+#include "cmCursesForm.h"
+#include "cmCursesMainForm.h"
+#include "cmCursesScreen.h"
+#include "cmCursesStandardIncludes.h"
+#include "cmLogger.h"
+#include "cmTrace.h"
+#include "cmVersion.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+inline int ctrl(int z)
+{
+  return (z & 037);
+}
+
+cmCursesListEditor::cmCursesListEditor(std::string const& value,
+                                       const char* title)
+  : Value(value)
+  , Title(title)
+{
+  cmTraceScope scope("SplitList");
+  // Break the value at non-escaped semicolons not nested in [], like
+  // cmSystemTools::ExpandListArgument().  An empty value has no
+  // elements.
+  size_t const size = this->Value.size();
+  size_t begin = 0;
+  int squareNesting = 0;
+  for (size_t i = 0; i < size; ++i) {
+    char const c = this->Value[i];
+    if (c == '\\' && i + 1 < size && this->Value[i + 1] == ';') {
+      ++i;
+    } else if (c == '[') {
+      ++squareNesting;
+    } else if (c == ']') {
+      --squareNesting;
+    } else if (c == ';' && squareNesting == 0) {
+      Element const element = { begin, i, false, std::string() };
+      this->Elements.push_back(element);
+      begin = i + 1;
+    }
+  }
+  if (size > 0) {
+    Element const element = { begin, size, false, std::string() };
+    this->Elements.push_back(element);
+  }
+
+  this->Modified = false;
+  this->Accepted = false;
+  this->Current = 0;
+  this->TopRow = 0;
+  this->ViewHeight = 1;
+  this->ViewWidth = 1;
+  this->Editing = false;
+  this->NewElement = false;
+  this->EditOffset = 0;
+}
+
+cmCursesListEditor::~cmCursesListEditor()
+{
+}
+
+const char* cmCursesListEditor::GetElementText(Element const& element,
+                                               size_t& length) const
+{
+  if (element.Changed) {
+    length = element.Text.size();
+    return element.Text.c_str();
+  }
+  length = element.End - element.Begin;
+  return this->Value.c_str() + element.Begin;
+}
+
+std::string cmCursesListEditor::GetValue() const
+{
+  cmTraceScope scope("JoinList");
+  std::string value;
+  size_t const count = this->Elements.size();
+  for (size_t i = 0; i < count;) {
+    if (i > 0) {
+      value += ';';
+    }
+    Element const& element = this->Elements[i];
+    if (element.Changed) {
+      value += element.Text;
+      ++i;
+      continue;
+    }
+    // Unchanged elements that are still next to each other are copied
+    // with the semicolons between them.
+    size_t last = i;
+    while (last + 1 < count && !this->Elements[last + 1].Changed &&
+           this->Elements[last + 1].Begin == this->Elements[last].End + 1) {
+      ++last;
+    }
+    value.append(this->Value, element.Begin,
+                 this->Elements[last].End - element.Begin);
+    i = last + 1;
+  }
+  return value;
+}
+
+void cmCursesListEditor::DrawLine(int line, std::string const& text,
+                                  bool standout)
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  // Writing the bottom right corner would scroll the screen.
+  int const width = line == y - 1 ? x - 1 : x;
+  if (width <= 0) {
+    return;
+  }
+  std::string padded = text;
+  padded.resize(static_cast<size_t>(width), ' ');
+  char fmt_s[] = "%s";
+  curses_move(line, 0);
+  if (standout) {
+    attron(A_STANDOUT);
+  }
+  printw(fmt_s, padded.c_str());
+  if (standout) {
+    attroff(A_STANDOUT);
+  }
+}
+
+void cmCursesListEditor::UpdateStatusBar()
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  char count[64];
+  sprintf(count, "  (%lu elements)",
+          static_cast<unsigned long>(this->Elements.size()));
+  DrawLine(y - 4, this->Title + count, true);
+
+  std::string version =
+    std::string("CMake Version ") + cmVersion::GetCMakeVersion();
+  if (version.size() < static_cast<size_t>(x)) {
+    version.insert(0, static_cast<size_t>(x) - version.size(), ' ');
+  }
+  DrawLine(y - 3, version, false);
+}
+
+void cmCursesListEditor::PrintKeys()
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  if (x < cmCursesMainForm::MIN_WIDTH || y < cmCursesMainForm::MIN_HEIGHT) {
+    return;
+  }
+  if (this->Editing) {
+    DrawLine(y - 2, "Editing element: press [enter] to keep it, "
+                    "[esc] to cancel",
+             false);
+    DrawLine(y - 1, "", false);
+    return;
+  }
+  DrawLine(y - 2, "Press [enter] to edit  [a] Add after  [i] Insert before  "
+                  "[d] Delete",
+           false);
+  DrawLine(y - 1, "Press [e] to keep the changes and exit  [q] Cancel",
+           false);
+}
+
+void cmCursesListEditor::DrawList()
+{
+  // Keep the current element on screen.
+  size_t const height = static_cast<size_t>(this->ViewHeight);
+  if (this->Current < this->TopRow) {
+    this->TopRow = this->Current;
+  } else if (this->Current >= this->TopRow + height) {
+    this->TopRow = this->Current - height + 1;
+  }
+
+  int cursorLine = 1;
+  int cursorColumn = 0;
+  for (int i = 0; i < this->ViewHeight; ++i) {
+    size_t const row = this->TopRow + static_cast<size_t>(i);
+    if (row >= this->Elements.size()) {
+      DrawLine(i + 1, row == 0 && i == 0 ? " EMPTY LIST" : "", false);
+      continue;
+    }
+    char number[32];
+    sprintf(number, " %6lu  ", static_cast<unsigned long>(row + 1));
+    std::string line = number;
+    size_t const prefix = line.size();
+    size_t const textWidth = static_cast<size_t>(this->ViewWidth) > prefix
+      ? static_cast<size_t>(this->ViewWidth) - prefix
+      : 1;
+    if (row == this->Current) {
+      cursorLine = i + 1;
+    }
+    if (this->Editing && row == this->Current) {
+      // Scroll the text sideways so that the cursor stays in view.
+      size_t const cursor = this->Buffer.GetCursor();
+      if (cursor < this->EditOffset) {
+        this->EditOffset = cursor;
+      } else if (cursor >= this->EditOffset + textWidth) {
+        this->EditOffset = cursor - textWidth + 1;
+      }
+      line += this->Buffer.GetText(this->EditOffset, textWidth);
+      cursorColumn = static_cast<int>(prefix + cursor - this->EditOffset);
+    } else {
+      size_t length;
+      const char* text = this->GetElementText(this->Elements[row], length);
+      line.append(text, std::min(length, textWidth));
+    }
+    DrawLine(i + 1, line, !this->Editing && row == this->Current);
+  }
+  this->PrintKeys();
+  curses_move(cursorLine, cursorColumn);
+  cmCursesScreen::Update();
+}
+
+void cmCursesListEditor::Render(int /*left*/, int /*top*/, int /*width*/,
+                                int /*height*/)
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  curses_clear();
+  this->ViewHeight = std::max(y - 6, 1);
+  this->ViewWidth = std::max(x, 1);
+  this->UpdateStatusBar();
+  this->DrawList();
+}
+
+void cmCursesListEditor::BeginEdit()
+{
+  size_t length;
+  const char* text =
+    this->GetElementText(this->Elements[this->Current], length);
+  this->Buffer.Assign(text, length);
+  this->EditOffset = 0;
+  this->Editing = true;
+}
+
+void cmCursesListEditor::EndEdit(bool keep)
+{
+  this->Editing = false;
+  Element& element = this->Elements[this->Current];
+  if (!keep) {
+    // An element that was just added goes away again.
+    if (this->NewElement) {
+      this->Elements.erase(this->Elements.begin() + this->Current);
+      if (this->Current > 0 && this->Current >= this->Elements.size()) {
+        --this->Current;
+      }
+    }
+    this->NewElement = false;
+    return;
+  }
+  size_t length;
+  const char* text = this->GetElementText(element, length);
+  std::string const edited = this->Buffer.GetText();
+  if (this->NewElement || edited.compare(0, edited.size(), text, length)) {
+    element.Changed = true;
+    element.Text = edited;
+    this->Modified = true;
+  }
+  this->NewElement = false;
+}
+
+void cmCursesListEditor::HandleEditKey(int key)
+{
+  size_t const cursor = this->Buffer.GetCursor();
+  if (key == 10 || key == KEY_ENTER) {
+    this->EndEdit(true);
+  } else if (key == 27) {
+    this->EndEdit(false);
+  } else if (key == KEY_LEFT || key == ctrl('b')) {
+    this->Buffer.MoveCursor(cursor > 0 ? cursor - 1 : 0);
+  } else if (key == KEY_RIGHT || key == ctrl('f')) {
+    this->Buffer.MoveCursor(cursor + 1);
+  } else if (key == KEY_HOME || key == ctrl('a')) {
+    this->Buffer.MoveCursor(0);
+  } else if (key == KEY_END || key == ctrl('e')) {
+    this->Buffer.MoveCursor(this->Buffer.GetSize());
+  } else if (key == ctrl('h') || key == KEY_BACKSPACE || key == 127) {
+    this->Buffer.DeleteBackward();
+  } else if (key == KEY_DC || key == ctrl('d')) {
+    this->Buffer.DeleteForward();
+  } else if (key >= ' ' && key < 127) {
+    this->Buffer.Insert(static_cast<char>(key));
+  }
+}
+
+void cmCursesListEditor::HandleInput()
+{
+  for (;;) {
+    int key = cmCursesScreen::GetKey();
+
+    cmLogger::Log(cmLogger::LevelTrace,
+                  "List editor handling input, key: %d", key);
+
+    bool const editing = this->Editing;
+    if (editing) {
+      this->HandleEditKey(key);
+    } else if (key == 'e') {
+      this->Accepted = true;
+      break;
+    } else if (key == 'q' || key == 27) {
+      break;
+    } else if (key == KEY_DOWN || key == ctrl('n') || key == 'j') {
+      if (this->Current + 1 < this->Elements.size()) {
+        ++this->Current;
+      }
+    } else if (key == KEY_UP || key == ctrl('p') || key == 'k') {
+      if (this->Current > 0) {
+        --this->Current;
+      }
+    } else if (key == KEY_NPAGE || key == ctrl('d')) {
+      size_t const last =
+        this->Elements.empty() ? 0 : this->Elements.size() - 1;
+      this->Current = std::min(
+        this->Current + static_cast<size_t>(this->ViewHeight), last);
+    } else if (key == KEY_PPAGE || key == ctrl('u')) {
+      size_t const page = static_cast<size_t>(this->ViewHeight);
+      this->Current = this->Current > page ? this->Current - page : 0;
+    } else if (key == KEY_HOME || key == 'g') {
+      this->Current = 0;
+    } else if (key == KEY_END || key == 'G') {
+      this->Current = this->Elements.empty() ? 0 : this->Elements.size() - 1;
+    } else if ((key == 10 || key == KEY_ENTER) && !this->Elements.empty()) {
+      this->BeginEdit();
+    } else if (key == 'a' || key == 'i') {
+      if (key == 'a' && !this->Elements.empty()) {
+        ++this->Current;
+      }
+      Element const element = { 0, 0, true, std::string() };
+      this->Elements.insert(this->Elements.begin() + this->Current, element);
+      this->NewElement = true;
+      this->BeginEdit();
+    } else if (key == 'd' && !this->Elements.empty()) {
+      this->Elements.erase(this->Elements.begin() + this->Current);
+      if (this->Current > 0 && this->Current >= this->Elements.size()) {
+        --this->Current;
+      }
+      this->Modified = true;
+    }
+
+    if (editing != this->Editing || key == 'a' || key == 'i' || key == 'd') {
+      this->UpdateStatusBar();
+    }
+    this->DrawList();
+  }
+}
@@ -0,0 +1,96 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmCursesListEditor_h
+#define cmCursesListEditor_h
+
+#include "cmConfigure.h"
+
+#include "cmCursesForm.h"
+#include "cmCursesStandardIncludes.h"
+#include "cmGapBuffer.h"
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/** \class cmCursesListEditor
+ * \brief Edits a ;-separated value one element at a time.
+ *
+ * The value is split once, at the semicolons where
+ * cmSystemTools::ExpandListArgument() splits it, but empty elements are
+ * kept so that the value reads back unchanged.  Elements refer to their
+ * text in the original value until they are edited; the element being
+ * edited is held in a gap buffer.  GetValue() copies runs of elements
+ * that were not changed from the original value in one piece.
+ */
+class cmCursesListEditor : public cmCursesForm
+{
+  CM_DISABLE_COPY(cmCursesListEditor)
+
+public:
+  cmCursesListEditor(std::string const& value, const char* title);
+  ~cmCursesListEditor() CM_OVERRIDE;
+
+  // Description:
+  // Handle user input.
+  void HandleInput() CM_OVERRIDE;
+
+  // Description:
+  // Display form. Use a window of size width x height, starting
+  // at top, left.
+  void Render(int left, int top, int width, int height) CM_OVERRIDE;
+
+  // Description:
+  // This method should normally  called only by the form.
+  // The only exception is during a resize.
+  void UpdateStatusBar() CM_OVERRIDE;
+
+  // Description:
+  // Whether the list was changed and the user asked to keep the
+  // changes.
+  bool IsModified() const { return this->Modified && this->Accepted; }
+
+  // Description:
+  // The edited value.
+  std::string GetValue() const;
+
+protected:
+  struct Element
+  {
+    size_t Begin; // span in Value, unless Changed
+    size_t End;
+    bool Changed;
+    std::string Text; // only if Changed
+  };
+
+  const char* GetElementText(Element const& element, size_t& length) const;
+  void PrintKeys();
+  void DrawList();
+  // Draw a line of the screen, padded to its width.
+  static void DrawLine(int line, std::string const& text, bool standout);
+  // Start and finish editing the current element.
+  void BeginEdit();
+  void EndEdit(bool keep);
+  // Handle a key while an element is edited.
+  void HandleEditKey(int key);
+
+  std::string Value;
+  std::string Title;
+  std::vector<Element> Elements;
+  bool Modified;
+  bool Accepted;
+
+  size_t Current;
+  size_t TopRow;
+  int ViewHeight;
+  int ViewWidth;
+
+  // The element being edited, whether it was just added, and its first
+  // column on screen
+  bool Editing;
+  bool NewElement;
+  cmGapBuffer Buffer;
+  size_t EditOffset;
+};
+
+#endif // cmCursesListEditor_h
@@ -4,10 +4,16 @@
 
 #include "cmCursesForm.h"
 #include "cmCursesMainForm.h"
+#include "cmCursesScreen.h"
 #include "cmCursesStandardIncludes.h"
+#include "cmLogger.h"
+#include "cmSystemTools.h"
+#include "cmTrace.h"
 #include "cmVersion.h"
 
+#include <algorithm>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 inline int ctrl(int z)
@@ -26,14 +32,35 @@ cmCursesLongMessageForm::cmCursesLongMessageForm(
     this->Messages += "\n\n";
   }
   this->Title = title;
-  this->Fields[0] = CM_NULLPTR;
-  this->Fields[1] = CM_NULLPTR;
+
+  // Other control characters would move the cursor, show them as
+  // spaces.
+  for (char& c : this->Messages) {
+    if (c != '\n' && (static_cast<unsigned char>(c) < ' ' || c == 127)) {
+      c = ' ';
+    }
+  }
+  // The newline at the very end does not start a line.
+  size_t const size = this->Messages.size();
+  this->LineStarts.push_back(0);
+  for (size_t pos = this->Messages.find('\n');
+       pos != std::string::npos && pos + 1 < size;
+       pos = this->Messages.find('\n', pos + 1)) {
+    this->LineStarts.push_back(pos + 1);
+  }
+
+  this->RowWidth = 0;
+  this->Pad = CM_NULLPTR;
+  this->ViewWidth = 0;
+  this->ViewHeight = 0;
+  this->TopRow = 0;
+  this->Match = std::string::npos;
 }
 
 cmCursesLongMessageForm::~cmCursesLongMessageForm()
 {
-  if (this->Fields[0]) {
-    free_field(this->Fields[0]);
+  if (this->Pad) {
+    delwin(this->Pad);
   }
 }
 
@@ -77,7 +104,21 @@ void cmCursesLongMessageForm::UpdateStatusBar()
   attroff(A_STANDOUT);
   curses_move(y - 3, 0);
   printw(fmt_s, version);
-  pos_form_cursor(this->Form);
+}
+
+void cmCursesLongMessageForm::DrawLine(int line, std::string text)
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  // Writing the bottom right corner would scroll the screen.
+  int const width = line == y - 1 ? x - 1 : x;
+  if (width <= 0) {
+    return;
+  }
+  text.resize(static_cast<size_t>(width), ' ');
+  char fmt_s[] = "%s";
+  curses_move(line, 0);
+  printw(fmt_s, text.c_str());
 }
 
 void cmCursesLongMessageForm::PrintKeys()
@@ -87,13 +128,109 @@ void cmCursesLongMessageForm::PrintKeys()
   if (x < cmCursesMainForm::MIN_WIDTH || y < cmCursesMainForm::MIN_HEIGHT) {
     return;
   }
-  char firstLine[512];
-  sprintf(firstLine, "Press [e] to exit help");
+  DrawLine(y - 2, "Press [e] to exit  [/] Search  [n] Next  [N] Previous  "
+                  "[:] Go to line");
 
-  char fmt_s[] = "%s";
-  curses_move(y - 2, 0);
-  printw(fmt_s, firstLine);
-  pos_form_cursor(this->Form);
+  if (!this->Notice.empty()) {
+    DrawLine(y - 1, this->Notice);
+    return;
+  }
+  size_t const line = static_cast<size_t>(
+    std::upper_bound(this->LineRows.begin(), this->LineRows.end(),
+                     this->TopRow) -
+    this->LineRows.begin());
+  char position[128];
+  sprintf(position, "Line %lu of %lu", static_cast<unsigned long>(line),
+          static_cast<unsigned long>(this->LineStarts.size()));
+  DrawLine(y - 1, position);
+}
+
+void cmCursesLongMessageForm::BuildRows(int width)
+{
+  if (width == this->RowWidth) {
+    return;
+  }
+  cmTraceScope scope("BuildRows");
+  this->RowWidth = width;
+  this->RowStarts.clear();
+  this->LineRows.clear();
+  this->LineRows.reserve(this->LineStarts.size());
+  size_t const columns = width > 0 ? static_cast<size_t>(width) : 1;
+  size_t textEnd = this->Messages.size();
+  if (textEnd > 0 && this->Messages[textEnd - 1] == '\n') {
+    --textEnd;
+  }
+  for (size_t line = 0; line < this->LineStarts.size(); ++line) {
+    size_t begin = this->LineStarts[line];
+    size_t const end = line + 1 < this->LineStarts.size()
+      ? this->LineStarts[line + 1] - 1
+      : textEnd;
+    this->LineRows.push_back(this->RowStarts.size());
+    this->RowStarts.push_back(begin);
+    // Wrap after the last space that fits, or inside a word that is
+    // longer than a row.
+    while (end - begin > columns) {
+      size_t space = begin + columns;
+      while (space > begin && this->Messages[space] != ' ') {
+        --space;
+      }
+      begin = space > begin ? space + 1 : begin + columns;
+      this->RowStarts.push_back(begin);
+    }
+  }
+}
+
+size_t cmCursesLongMessageForm::GetLastTopRow() const
+{
+  size_t const height = static_cast<size_t>(this->ViewHeight);
+  return this->RowStarts.size() > height ? this->RowStarts.size() - height
+                                         : 0;
+}
+
+void cmCursesLongMessageForm::ShowRow(size_t row)
+{
+  if (row < this->TopRow ||
+      row >= this->TopRow + static_cast<size_t>(this->ViewHeight)) {
+    this->TopRow = std::min(row, this->GetLastTopRow());
+  }
+}
+
+void cmCursesLongMessageForm::DrawView()
+{
+  werase(this->Pad);
+  const char* const text = this->Messages.c_str();
+  size_t const matchEnd = this->Match + this->SearchString.size();
+  for (int i = 0; i < this->ViewHeight; ++i) {
+    size_t const row = this->TopRow + static_cast<size_t>(i);
+    if (row >= this->RowStarts.size()) {
+      break;
+    }
+    size_t const begin = this->RowStarts[row];
+    size_t end = row + 1 < this->RowStarts.size() ? this->RowStarts[row + 1]
+                                                  : this->Messages.size();
+    // Leave out the newline or the space where the line wraps.
+    if (end > begin && (text[end - 1] == '\n' || text[end - 1] == ' ')) {
+      --end;
+    }
+    end = std::min(end, begin + static_cast<size_t>(this->ViewWidth));
+    wmove(this->Pad, i, 0);
+    if (this->Match == std::string::npos || this->Match >= end ||
+        matchEnd <= begin) {
+      waddnstr(this->Pad, text + begin, static_cast<int>(end - begin));
+      continue;
+    }
+    // Highlight the part of the match in this row.
+    size_t const from = std::max(begin, this->Match);
+    size_t const to = std::min(end, matchEnd);
+    waddnstr(this->Pad, text + begin, static_cast<int>(from - begin));
+    wattron(this->Pad, A_STANDOUT);
+    waddnstr(this->Pad, text + from, static_cast<int>(to - from));
+    wattroff(this->Pad, A_STANDOUT);
+    waddnstr(this->Pad, text + to, static_cast<int>(end - to));
+  }
+  this->PrintKeys();
+  cmCursesScreen::UpdatePad(this->Pad, 1, 1, this->ViewHeight,
+                            this->ViewWidth);
 }
 
 void cmCursesLongMessageForm::Render(int /*left*/, int /*top*/, int /*width*/,
@@ -102,77 +239,147 @@ void cmCursesLongMessageForm::Render(int /*left*/, int /*top*/, int /*width*/,
   int x, y;
   getmaxyx(stdscr, y, x);
 
-  if (this->Form) {
-    unpost_form(this->Form);
-    free_form(this->Form);
-    this->Form = CM_NULLPTR;
-  }
-
-  const char* msg = this->Messages.c_str();
-
   curses_clear();
 
-  if (this->Fields[0]) {
-    free_field(this->Fields[0]);
-    this->Fields[0] = CM_NULLPTR;
+  if (this->Pad) {
+    delwin(this->Pad);
   }
+  this->ViewHeight = std::max(y - 6, 1);
+  this->ViewWidth = std::max(x - 2, 1);
+  this->Pad = newpad(this->ViewHeight, this->ViewWidth);
 
-  this->Fields[0] = new_field(y - 6, x - 2, 1, 1, 0, 0);
-
-  field_opts_off(this->Fields[0], O_STATIC);
+  // Keep the line at the top of the view when the rows change.
+  if (this->ViewWidth != this->RowWidth) {
+    size_t line = static_cast<size_t>(
+      std::upper_bound(this->LineRows.begin(), this->LineRows.end(),
+                       this->TopRow) -
+      this->LineRows.begin());
+    line = line > 0 ? line - 1 : 0;
+    this->BuildRows(this->ViewWidth);
+    this->TopRow = this->LineRows[line];
+  }
+  this->TopRow = std::min(this->TopRow, this->GetLastTopRow());
 
-  this->Form = new_form(this->Fields);
-  post_form(this->Form);
+  this->UpdateStatusBar();
+  this->DrawView();
+}
 
-  int i = 0;
-  form_driver(this->Form, REQ_BEG_FIELD);
-  while (msg[i] != '\0' && i < 60000) {
-    if (msg[i] == '\n' && msg[i + 1] != '\0') {
-      form_driver(this->Form, REQ_NEW_LINE);
-    } else {
-      form_driver(this->Form, msg[i]);
+void cmCursesLongMessageForm::FindNext(size_t from, bool forward)
+{
+  if (this->FoldedMessages.empty()) {
+    this->FoldedMessages = cmSystemTools::LowerCase(this->Messages);
+  }
+  std::string const& text = this->FoldedMessages;
+  std::string const& str = this->SearchString;
+  size_t pos;
+  if (forward) {
+    pos = text.find(str, from);
+  } else {
+    pos = from > 0 ? text.rfind(str, from - 1) : std::string::npos;
+  }
+  if (pos == std::string::npos) {
+    pos = forward ? text.find(str) : text.rfind(str);
+    if (pos == std::string::npos) {
+      this->Match = std::string::npos;
+      this->Notice = "Not found: " + str;
+      return;
     }
-    i++;
+    this->Notice = forward ? "Search continued from the top"
+                           : "Search continued from the bottom";
   }
-  form_driver(this->Form, REQ_BEG_FIELD);
+  this->Match = pos;
+  this->ShowRow(static_cast<size_t>(
+    std::upper_bound(this->RowStarts.begin(), this->RowStarts.end(), pos) -
+    this->RowStarts.begin() - 1));
+}
 
-  this->UpdateStatusBar();
-  this->PrintKeys();
-  touchwin(stdscr);
-  refresh();
+bool cmCursesLongMessageForm::PromptString(const char* prompt,
+                                           std::string& str)
+{
+  int x, y;
+  for (;;) {
+    getmaxyx(stdscr, y, x);
+    std::string const line = prompt + str;
+    DrawLine(y - 1, line);
+    curses_move(y - 1, static_cast<unsigned int>(line.size()));
+    cmCursesScreen::Update();
+
+    int key = cmCursesScreen::GetKey();
+    if (key == 10 || key == KEY_ENTER) {
+      return true;
+    }
+    // esc
+    if (key == 27) {
+      return false;
+    }
+    if (key == ctrl('h') || key == KEY_BACKSPACE || key == 127) {
+      if (!str.empty()) {
+        str.resize(str.size() - 1);
+      }
+    } else if (key >= ' ' && key < 127 &&
+               line.size() < static_cast<std::string::size_type>(x - 2)) {
+      str += static_cast<char>(key);
+    }
+  }
 }
 
 void cmCursesLongMessageForm::HandleInput()
 {
-  if (!this->Form) {
+  if (!this->Pad) {
     return;
   }
 
-  char debugMessage[128];
-
   for (;;) {
-    int key = getch();
+    int key = cmCursesScreen::GetKey();
 
-    sprintf(debugMessage, "Message widget handling input, key: %d", key);
-    cmCursesForm::LogMessage(debugMessage);
+    cmLogger::Log(cmLogger::LevelTrace,
+                  "Message widget handling input, key: %d", key);
 
     // quit
     if (key == 'o' || key == 'e') {
       break;
     }
+    this->Notice.clear();
+    size_t const lastTop = this->GetLastTopRow();
+    size_t const page = static_cast<size_t>(this->ViewHeight);
     if (key == KEY_DOWN || key == ctrl('n')) {
-      form_driver(this->Form, REQ_SCR_FLINE);
+      this->TopRow = std::min(this->TopRow + 1, lastTop);
     } else if (key == KEY_UP || key == ctrl('p')) {
-      form_driver(this->Form, REQ_SCR_BLINE);
+      this->TopRow = this->TopRow > 0 ? this->TopRow - 1 : 0;
     } else if (key == KEY_NPAGE || key == ctrl('d')) {
-      form_driver(this->Form, REQ_SCR_FPAGE);
+      this->TopRow = std::min(this->TopRow + page, lastTop);
     } else if (key == KEY_PPAGE || key == ctrl('u')) {
-      form_driver(this->Form, REQ_SCR_BPAGE);
+      this->TopRow = this->TopRow > page ? this->TopRow - page : 0;
+    } else if (key == KEY_HOME || key == 'g') {
+      this->TopRow = 0;
+    } else if (key == KEY_END || key == 'G') {
+      this->TopRow = lastTop;
+    } else if (key == '/') {
+      std::string str;
+      if (this->PromptString("Search: ", str) && !str.empty()) {
+        this->SearchString = cmSystemTools::LowerCase(str);
+        this->FindNext(this->RowStarts[this->TopRow], true);
+      }
+    } else if ((key == 'n' || key == 'N') && !this->SearchString.empty()) {
+      bool const forward = key == 'n';
+      size_t from = this->RowStarts[this->TopRow];
+      if (this->Match != std::string::npos) {
+        from = forward ? this->Match + 1 : this->Match;
+      }
+      this->FindNext(from, forward);
+    } else if (key == ':') {
+      std::string str;
+      if (this->PromptString("Go to line: ", str) && !str.empty()) {
+        unsigned long const line = strtoul(str.c_str(), CM_NULLPTR, 10);
+        if (line >= 1 && line <= this->LineStarts.size()) {
+          this->TopRow = std::min(this->LineRows[line - 1], lastTop);
+        } else {
+          this->Notice = "No line " + str;
+        }
+      }
     }
 
     this->UpdateStatusBar();
-    this->PrintKeys();
-    touchwin(stdscr);
-    wrefresh(stdscr);
+    this->DrawView();
   }
 }
@@ -8,9 +8,18 @@
 #include "cmCursesForm.h"
 #include "cmCursesStandardIncludes.h"
 
+#include <stddef.h>
 #include <string>
 #include <vector>
 
+/** \class cmCursesLongMessageForm
+ * \brief Shows a long text, such as the output of a configure step.
+ *
+ * The start of every line of the text is indexed once, and the rows
+ * that the lines wrap into are indexed when the width changes, so
+ * going to any line or row takes constant time.  Only the rows on
+ * screen are drawn, into a pad the size of the view.
+ */
 class cmCursesLongMessageForm : public cmCursesForm
 {
   CM_DISABLE_COPY(cmCursesLongMessageForm)
@@ -40,10 +49,47 @@ public:
   void UpdateStatusBar() CM_OVERRIDE;
 
 protected:
+  // Index the rows of the text for the given width.
+  void BuildRows(int width);
+  // Draw the rows on screen into the pad and show it.
+  void DrawView();
+  // The last row that can be at the top of the view.
+  size_t GetLastTopRow() const;
+  // Scroll so that the row is on screen.
+  void ShowRow(size_t row);
+  // Find the search string from the offset, forward or backward,
+  // wrapping around, and show the match.
+  void FindNext(size_t from, bool forward);
+  // Read a line of text below the status bar. Returns false if the
+  // user cancelled with escape.
+  bool PromptString(const char* prompt, std::string& str);
+  // Draw a line of the screen, padded to its width.
+  static void DrawLine(int line, std::string text);
+
   std::string Messages;
   std::string Title;
 
-  FIELD* Fields[2];
+  // Offset of the start of every line of Messages
+  std::vector<size_t> LineStarts;
+  // Offset of the start of every row, once the lines are wrapped to
+  // RowWidth columns, and the row of the start of every line
+  std::vector<size_t> RowStarts;
+  std::vector<size_t> LineRows;
+  int RowWidth;
+
+  // The view, and the row at its top
+  WINDOW* Pad;
+  int ViewWidth;
+  int ViewHeight;
+  size_t TopRow;
+
+  // Messages in lower case, made on the first search, the searched
+  // string in lower case and the offset of the match shown
+  std::string FoldedMessages;
+  std::string SearchString;
+  size_t Match;
+  // Shown on the last line, such as a failed search
+  std::string Notice;
 };
 
 #endif // cmCursesLongMessageForm_h
@@ -2,29 +2,45 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCursesMainForm.h"
 
-#include "cmAlgorithms.h"
+#include "cmCacheDiff.h"
+#include "cmCacheSearch.h"
 #include "cmCursesCacheEntryComposite.h"
 #include "cmCursesDummyWidget.h"
 #include "cmCursesForm.h"
 #include "cmCursesLabelWidget.h"
+#include "cmCursesListEditor.h"
 #include "cmCursesLongMessageForm.h"
+#include "cmCursesScreen.h"
 #include "cmCursesStandardIncludes.h"
 #include "cmCursesStringWidget.h"
 #include "cmCursesWidget.h"
+#include "cmLogger.h"
 #include "cmState.h"
 #include "cmStateTypes.h"
 #include "cmSystemTools.h"
+#include "cmTrace.h"
 #include "cmVersion.h"
 #include "cmake.h"
 
+#include <algorithm>
+#include <ctype.h>
+#include <memory>
 #include <stdio.h>
 #include <string.h>
+#include <unordered_map>
 
 inline int ctrl(int z)
 {
   return (z & 037);
 }
 
+// Whether entries of this type are shown in the form at all.
+inline bool IsEditable(cmStateEnums::CacheEntryType type)
+{
+  return type != cmStateEnums::INTERNAL && type != cmStateEnums::STATIC &&
+    type != cmStateEnums::UNINITIALIZED;
+}
+
 cmCursesMainForm::cmCursesMainForm(std::vector<std::string> const& args,
                                    int initWidth)
   : Args(args)
@@ -32,8 +48,12 @@ cmCursesMainForm::cmCursesMainForm(std::vector<std::string> const& args,
 {
   this->NumberOfPages = 0;
   this->Fields = CM_NULLPTR;
-  this->Entries = CM_NULLPTR;
+  this->EmptyEntry = CM_NULLPTR;
+  this->NoMatchEntry = CM_NULLPTR;
+  this->FirstRow = 0;
+  this->PageSize = 1;
   this->AdvancedMode = false;
+  this->TreeMode = false;
   this->NumberOfVisibleEntries = 0;
   this->OkToGenerate = false;
   this->HelpMessage.push_back(
@@ -52,215 +72,507 @@ cmCursesMainForm::cmCursesMainForm(std::vector<std::string> const& args,
   this->SearchString = "";
   this->OldSearchString = "";
   this->SearchMode = false;
+  this->FilterMode = false;
+  this->LoadingCache = false;
+  this->CMakeInstance->SetCacheCallback(cmCursesMainForm::CacheLoaded, this);
 }
 
 cmCursesMainForm::~cmCursesMainForm()
 {
-  if (this->Form) {
-    unpost_form(this->Form);
-    free_form(this->Form);
-    this->Form = CM_NULLPTR;
-  }
+  this->FreeForm();
   delete[] this->Fields;
 
   // Clean-up composites
-  if (this->Entries) {
-    cmDeleteAll(*this->Entries);
+  this->ClearTrees();
+  for (size_t row : this->LiveRows) {
+    delete this->Entries[row].Composite;
   }
-  delete this->Entries;
+  delete this->EmptyEntry;
+  delete this->NoMatchEntry;
   if (this->CMakeInstance) {
     delete this->CMakeInstance;
     this->CMakeInstance = CM_NULLPTR;
   }
 }
 
-// See if a cache entry is in the list of entries in the ui.
-bool cmCursesMainForm::LookForCacheEntry(const std::string& key)
+// Create new cmCursesCacheEntryComposite entries from the cache
+void cmCursesMainForm::InitializeUI()
 {
-  if (!this->Entries) {
-    return false;
+  cmTraceScope scope("InitializeUI");
+  std::uint64_t const start = uv_hrtime();
+
+  cmState* state = this->CMakeInstance->GetState();
+  this->ServerCache = state->TakeSnapshot();
+
+  // Mark the entries that were not shown before as new. The marks are
+  // part of the cache state, so undo and redo bring them back.
+  std::vector<cmStateEnums::CacheEntryType> const& types =
+    state->GetTypeColumn();
+  cmState::EntryId const numberOfEntries =
+    static_cast<cmState::EntryId>(types.size());
+
+  auto const keyLess = [](const char* lhs, const char* rhs) {
+    return strcmp(lhs, rhs) < 0;
+  };
+  std::vector<const char*> oldKeys;
+  oldKeys.reserve(this->Entries.size());
+  for (EntryRow const& entry : this->Entries) {
+    oldKeys.push_back(entry.Key);
+  }
+  std::sort(oldKeys.begin(), oldKeys.end(), keyLess);
+  for (cmState::EntryId id = 0; id < numberOfEntries; ++id) {
+    if (!IsEditable(types[id])) {
+      continue;
+    }
+    const char* key = state->GetCacheEntryKey(id);
+    bool const isNew =
+      !std::binary_search(oldKeys.begin(), oldKeys.end(), key, keyLess);
+    state->SetCacheEntryFlag(id, cmState::FlagNew, isNew);
+    if (isNew) {
+      this->OkToGenerate = false;
+    }
   }
 
-  std::vector<cmCursesCacheEntryComposite*>::iterator it;
-  for (it = this->Entries->begin(); it != this->Entries->end(); ++it) {
-    if (key == (*it)->Key) {
-      return true;
+  this->CreateEntries();
+
+  std::uint64_t const elapsed = uv_hrtime() - start;
+  this->CMakeInstance->GetMetrics().Get("cache").UIRebuild.Add(elapsed);
+}
+
+void cmCursesMainForm::CreateEntries()
+{
+  // Clean old entries; their fields must not be part of a form
+  this->FreeForm();
+  for (size_t row : this->LiveRows) {
+    delete this->Entries[row].Composite;
+  }
+  this->LiveRows.clear();
+  this->Entries.clear();
+
+  // List the entries: entries which are new come first, then entries
+  // which are old.  Their widgets are created when they are shown.
+  cmState const* state = this->CMakeInstance->GetState();
+  std::vector<cmStateEnums::CacheEntryType> const& types =
+    state->GetTypeColumn();
+  cmState::EntryId const numberOfEntries =
+    static_cast<cmState::EntryId>(types.size());
+  this->Entries.reserve(types.size());
+  std::vector<EntryRow> oldEntries;
+  for (cmState::EntryId id = 0; id < numberOfEntries; ++id) {
+    if (!IsEditable(types[id]) ||
+        state->GetCacheEntryFlag(id, cmState::FlagRemoved)) {
+      continue;
+    }
+    bool const isNew = state->GetCacheEntryFlag(id, cmState::FlagNew);
+    EntryRow const entry = { id, state->GetCacheEntryKey(id), isNew,
+                             CM_NULLPTR };
+    if (isNew) {
+      this->Entries.push_back(entry);
+    } else {
+      oldEntries.push_back(entry);
     }
   }
+  this->Entries.insert(this->Entries.end(), oldEntries.begin(),
+                       oldEntries.end());
+  this->EntriesPool = state->GetStringPool();
 
-  return false;
+  // Compute fields from composites
+  this->UpdateVisibleRows();
+  this->UpdateFilter();
+  this->ClearTrees();
+  if (this->TreeMode) {
+    this->UpdateTreeRows();
+  }
+  this->RePost();
 }
 
-// Create new cmCursesCacheEntryComposite entries from the cache
-void cmCursesMainForm::InitializeUI()
+void cmCursesMainForm::UpdateVisibleRows()
 {
-  // Create a vector of cmCursesCacheEntryComposite's
-  // which contain labels, entries and new entry markers
-  std::vector<cmCursesCacheEntryComposite*>* newEntries =
-    new std::vector<cmCursesCacheEntryComposite*>;
-  std::vector<std::string> cacheKeys =
-    this->CMakeInstance->GetState()->GetCacheEntryKeys();
-  newEntries->reserve(cacheKeys.size());
-
-  // Count non-internal and non-static entries
-  int count = 0;
-
-  for (std::vector<std::string>::const_iterator it = cacheKeys.begin();
-       it != cacheKeys.end(); ++it) {
-    cmStateEnums::CacheEntryType t =
-      this->CMakeInstance->GetState()->GetCacheEntryType(*it);
-    if (t != cmStateEnums::INTERNAL && t != cmStateEnums::STATIC &&
-        t != cmStateEnums::UNINITIALIZED) {
-      ++count;
+  this->NormalRows.clear();
+  this->AdvancedRows.clear();
+  cmState const* state = this->CMakeInstance->GetState();
+  cmState::EntryId const numberOfEntries =
+    static_cast<cmState::EntryId>(state->GetNumberOfCacheEntries());
+  for (size_t i = 0; i < this->Entries.size(); ++i) {
+    cmState::EntryId const id = this->Entries[i].Id;
+    if (id >= numberOfEntries) {
+      continue;
+    }
+    this->AdvancedRows.push_back(i);
+    if (!state->GetCacheEntryFlag(id, cmState::FlagAdvanced)) {
+      this->NormalRows.push_back(i);
     }
   }
+}
 
-  int entrywidth = this->InitialWidth - 35;
+cmCursesCacheEntryComposite* cmCursesMainForm::GetRowEntry(size_t row) const
+{
+  if (row < this->Entries.size()) {
+    return this->Entries[row].Composite;
+  }
+  return this->GetGroupNode(row).Header;
+}
 
-  cmCursesCacheEntryComposite* comp;
-  if (count == 0) {
-    // If cache is empty, display a label saying so and a
-    // dummy entry widget (does not respond to input)
-    comp = new cmCursesCacheEntryComposite("EMPTY CACHE", 30, 30);
-    comp->Entry = new cmCursesDummyWidget(1, 1, 1, 1);
-    newEntries->push_back(comp);
-  } else {
-    // Create the composites.
-
-    // First add entries which are new
-    for (std::vector<std::string>::const_iterator it = cacheKeys.begin();
-         it != cacheKeys.end(); ++it) {
-      std::string key = *it;
-      cmStateEnums::CacheEntryType t =
-        this->CMakeInstance->GetState()->GetCacheEntryType(*it);
-      if (t == cmStateEnums::INTERNAL || t == cmStateEnums::STATIC ||
-          t == cmStateEnums::UNINITIALIZED) {
-        continue;
-      }
+const char* cmCursesMainForm::GetRowKey(size_t row) const
+{
+  if (row < this->Entries.size()) {
+    return this->Entries[row].Key;
+  }
+  return this->GetGroupNode(row).Prefix.c_str();
+}
 
-      if (!this->LookForCacheEntry(key)) {
-        newEntries->push_back(new cmCursesCacheEntryComposite(
-          key, this->CMakeInstance, true, 30, entrywidth));
-        this->OkToGenerate = false;
-      }
-    }
+cmCursesMainForm::TreeNode& cmCursesMainForm::GetGroupNode(size_t row)
+{
+  EntryTree& tree = this->GetCurrentTree();
+  return tree.Nodes[tree.Groups[row - this->Entries.size()]];
+}
 
-    // then add entries which are old
-    for (std::vector<std::string>::const_iterator it = cacheKeys.begin();
-         it != cacheKeys.end(); ++it) {
-      std::string key = *it;
-      cmStateEnums::CacheEntryType t =
-        this->CMakeInstance->GetState()->GetCacheEntryType(*it);
-      if (t == cmStateEnums::INTERNAL || t == cmStateEnums::STATIC ||
-          t == cmStateEnums::UNINITIALIZED) {
-        continue;
+cmCursesMainForm::TreeNode const& cmCursesMainForm::GetGroupNode(
+  size_t row) const
+{
+  EntryTree const& tree = this->Trees[this->AdvancedMode ? 1 : 0];
+  return tree.Nodes[tree.Groups[row - this->Entries.size()]];
+}
+
+void cmCursesMainForm::BuildTree(EntryTree& tree, std::vector<size_t> rows)
+{
+  cmTraceScope scope("BuildTree");
+  std::vector<EntryRow> const& entries = this->Entries;
+  std::sort(rows.begin(), rows.end(), [&entries](size_t lhs, size_t rhs) {
+    return strcmp(entries[lhs].Key, entries[rhs].Key) < 0;
+  });
+  tree.Nodes.clear();
+  tree.Groups.clear();
+  this->AddTreeNodes(tree, rows, 0, rows.size(), 0, 0);
+  tree.Valid = true;
+}
+
+void cmCursesMainForm::AddTreeNodes(EntryTree& tree,
+                                    std::vector<size_t> const& rows,
+                                    size_t begin, size_t end, size_t offset,
+                                    int depth)
+{
+  std::vector<EntryRow> const& entries = this->Entries;
+  size_t i = begin;
+  while (i < end) {
+    std::string const key = entries[rows[i]].Key;
+    std::string::size_type sep = key.find('_', offset);
+    size_t next = i + 1;
+    if (sep != std::string::npos) {
+      // The keys are sorted, so the ones with the same prefix follow.
+      size_t length = sep + 1;
+      while (next < end &&
+             strncmp(key.c_str(), entries[rows[next]].Key, length) == 0) {
+        ++next;
       }
+      if (next - i > 1) {
+        // Skip levels that would only hold one group.  What the first
+        // and the last key share, all keys in between share.
+        const char* last = entries[rows[next - 1]].Key;
+        for (sep = key.find('_', length);
+             sep != std::string::npos &&
+             strncmp(key.c_str(), last, sep + 1) == 0;
+             sep = key.find('_', length)) {
+          length = sep + 1;
+        }
 
-      if (this->LookForCacheEntry(key)) {
-        newEntries->push_back(new cmCursesCacheEntryComposite(
-          key, this->CMakeInstance, false, 30, entrywidth));
+        TreeNode group;
+        group.Row = this->Entries.size() + tree.Groups.size();
+        group.Prefix = key.substr(0, length);
+        group.Count = next - i;
+        group.Depth = depth;
+        group.Open = this->OpenGroups.count(group.Prefix) != 0;
+        group.Header = CM_NULLPTR;
+
+        size_t const node = tree.Nodes.size();
+        tree.Groups.push_back(node);
+        tree.Nodes.push_back(group);
+        this->AddTreeNodes(tree, rows, i, next, length, depth + 1);
+        tree.Nodes[node].End = tree.Nodes.size();
+        i = next;
+        continue;
       }
     }
+    TreeNode entry;
+    entry.Row = rows[i];
+    entry.End = tree.Nodes.size() + 1;
+    entry.Count = 1;
+    entry.Depth = depth;
+    entry.Open = false;
+    entry.Header = CM_NULLPTR;
+    tree.Nodes.push_back(entry);
+    i = next;
   }
+}
 
-  // Clean old entries
-  if (this->Entries) {
-    cmDeleteAll(*this->Entries);
+void cmCursesMainForm::CreateGroupHeader(TreeNode& node)
+{
+  int entrywidth = this->InitialWidth - 35;
+  node.Header = new cmCursesCacheEntryComposite("", 30, entrywidth);
+  delete node.Header->Entry;
+  node.Header->Entry = new cmCursesDummyWidget(entrywidth, 1, 1, 1);
+  char count[64];
+  sprintf(count, "%lu entries", static_cast<unsigned long>(node.Count));
+  node.Header->Entry->SetValue(count);
+  SetGroupLabel(node);
+}
+
+void cmCursesMainForm::SetGroupLabel(TreeNode const& node)
+{
+  if (!node.Header) {
+    return;
   }
-  delete this->Entries;
-  this->Entries = newEntries;
+  std::string label(2 * static_cast<size_t>(node.Depth), ' ');
+  label += node.Open ? "[-] " : "[+] ";
+  label += node.Prefix;
+  node.Header->Label->SetValue(label);
+}
 
-  // Compute fields from composites
+void cmCursesMainForm::ClearTrees()
+{
+  // The fields of the headers must not be part of a form.
+  this->FreeForm();
+  for (TreeNode* node : this->LiveGroups) {
+    delete node->Header;
+  }
+  this->LiveGroups.clear();
+  for (EntryTree& tree : this->Trees) {
+    tree.Nodes.clear();
+    tree.Groups.clear();
+    tree.Valid = false;
+  }
+  this->TreeRows.clear();
+  this->TreeRowNodes.clear();
+}
+
+void cmCursesMainForm::UpdateTreeRows()
+{
+  EntryTree& tree = this->GetCurrentTree();
+  if (!tree.Valid) {
+    this->BuildTree(tree, this->AdvancedMode ? this->AdvancedRows
+                                             : this->NormalRows);
+  }
+  // Closed groups are skipped as a whole.
+  this->TreeRows.clear();
+  this->TreeRowNodes.clear();
+  size_t i = 0;
+  while (i < tree.Nodes.size()) {
+    TreeNode const& node = tree.Nodes[i];
+    this->TreeRows.push_back(node.Row);
+    this->TreeRowNodes.push_back(i);
+    i = (node.Prefix.empty() || node.Open) ? i + 1 : node.End;
+  }
+}
+
+cmCursesMainForm::TreeNode* cmCursesMainForm::GetCurrentGroup()
+{
+  if (!this->TreeMode || !this->Form || this->IsFiltered()) {
+    return CM_NULLPTR;
+  }
+  size_t const index = this->GetCurrentIndex();
+  if (index >= this->TreeRowNodes.size()) {
+    return CM_NULLPTR;
+  }
+  TreeNode& node = this->GetCurrentTree().Nodes[this->TreeRowNodes[index]];
+  return node.Prefix.empty() ? CM_NULLPTR : &node;
+}
+
+void cmCursesMainForm::ToggleCurrentGroup()
+{
+  TreeNode* node = this->GetCurrentGroup();
+  if (!node) {
+    return;
+  }
+  node->Open = !node->Open;
+  if (node->Open) {
+    this->OpenGroups.insert(node->Prefix);
+  } else {
+    this->OpenGroups.erase(node->Prefix);
+  }
+  SetGroupLabel(*node);
+
+  // The rows before the header do not change.
+  size_t const index = this->GetCurrentIndex();
+  this->UpdateTreeRows();
   this->RePost();
+  this->ShowRow(index);
+}
+
+// Remove the row of an entry from a visibility index and shift the
+// rows that follow it.
+static void RemoveVisibleRow(std::vector<size_t>& rows, size_t row)
+{
+  std::vector<size_t>::iterator it =
+    std::lower_bound(rows.begin(), rows.end(), row);
+  if (it != rows.end() && *it == row) {
+    it = rows.erase(it);
+  }
+  for (; it != rows.end(); ++it) {
+    --*it;
+  }
 }
 
 void cmCursesMainForm::RePost()
 {
-  // Create the fields to be passed to the form.
+  cmTraceScope scope("RePost");
+
+  // The fields are created by Render() for the rows on screen.
+  this->FreeForm();
+  // The visible rows have changed.
+  this->KeyIndex.Valid = false;
+  this->FirstRow = 0;
+  this->NumberOfVisibleEntries = this->GetVisibleRows().size();
+}
+
+void cmCursesMainForm::FreeForm()
+{
   if (this->Form) {
     unpost_form(this->Form);
     free_form(this->Form);
     this->Form = CM_NULLPTR;
   }
-  delete[] this->Fields;
-  if (this->AdvancedMode) {
-    this->NumberOfVisibleEntries = this->Entries->size();
-  } else {
-    // If normal mode, count only non-advanced entries
-    this->NumberOfVisibleEntries = 0;
-    std::vector<cmCursesCacheEntryComposite*>::iterator it;
-    for (it = this->Entries->begin(); it != this->Entries->end(); ++it) {
-      const char* existingValue =
-        this->CMakeInstance->GetState()->GetCacheEntryValue((*it)->GetValue());
-      bool advanced =
-        this->CMakeInstance->GetState()->GetCacheEntryPropertyAsBool(
-          (*it)->GetValue(), "ADVANCED");
-      if (!existingValue || (!this->AdvancedMode && advanced)) {
-        continue;
-      }
-      this->NumberOfVisibleEntries++;
-    }
+}
+
+size_t cmCursesMainForm::GetCurrentIndex() const
+{
+  if (!this->Form) {
+    return this->FirstRow;
   }
-  // there is always one even if it is the dummy one
-  if (this->NumberOfVisibleEntries == 0) {
-    this->NumberOfVisibleEntries = 1;
+  return this->FirstRow +
+    static_cast<size_t>(field_index(current_field(this->Form))) / 3;
+}
+
+void cmCursesMainForm::ShowRow(size_t index)
+{
+  if (index >= this->GetVisibleRows().size()) {
+    return;
   }
-  // Assign the fields: 3 for each entry: label, new entry marker
-  // ('*' or ' ') and entry widget
-  this->Fields = new FIELD*[3 * this->NumberOfVisibleEntries + 1];
-  size_t cc;
-  for (cc = 0; cc < 3 * this->NumberOfVisibleEntries + 1; cc++) {
-    this->Fields[cc] = CM_NULLPTR;
-  }
-
-  // Assign fields
-  int j = 0;
-  std::vector<cmCursesCacheEntryComposite*>::iterator it;
-  for (it = this->Entries->begin(); it != this->Entries->end(); ++it) {
-    const char* existingValue =
-      this->CMakeInstance->GetState()->GetCacheEntryValue((*it)->GetValue());
-    bool advanced =
-      this->CMakeInstance->GetState()->GetCacheEntryPropertyAsBool(
-        (*it)->GetValue(), "ADVANCED");
-    if (!existingValue || (!this->AdvancedMode && advanced)) {
-      continue;
+  if (!this->Form || index < this->FirstRow ||
+      index >= this->FirstRow + this->PageSize) {
+    int x, y;
+    getmaxyx(stdscr, y, x);
+    // The fields of the form belong to the old page.
+    this->FreeForm();
+    this->FirstRow = index - index % this->PageSize;
+    this->Render(1, 1, x, y);
+  }
+  if (this->Form) {
+    set_current_field(this->Form,
+                      this->Fields[3 * (index - this->FirstRow) + 2]);
+  }
+}
+
+// scroll down with arrow down, ctrl+n (emacs binding), or j (vim binding)
+static bool IsDownKey(int key)
+{
+  return key == KEY_DOWN || key == ctrl('n') || key == 'j';
+}
+
+// scroll up with arrow up, ctrl+p (emacs binding), or k (vim binding)
+static bool IsUpKey(int key)
+{
+  return key == KEY_UP || key == ctrl('p') || key == 'k';
+}
+
+static bool IsPageDownKey(int key)
+{
+  return key == KEY_NPAGE || key == ctrl('d');
+}
+
+static bool IsPageUpKey(int key)
+{
+  return key == KEY_PPAGE || key == ctrl('u');
+}
+
+bool cmCursesMainForm::IsNavigationKey(int key)
+{
+  return IsDownKey(key) || IsUpKey(key) || IsPageDownKey(key) ||
+    IsPageUpKey(key);
+}
+
+bool cmCursesMainForm::IsViewingKey(int key)
+{
+  // help, errors, search, filter, find and esc to show all again
+  return IsNavigationKey(key) || key == 'h' || key == 'l' || key == '/' ||
+    key == 'n' || key == 'f' || key == '?' || key == 27;
+}
+
+size_t cmCursesMainForm::MoveIndex(int key, size_t index) const
+{
+  size_t const count = this->NumberOfVisibleEntries;
+  size_t const first = index - index % this->PageSize;
+  // next entry; if it is not on screen, show the next page
+  if (IsDownKey(key) && index + 1 < count) {
+    return index + 1;
+  }
+  // previous entry; if it is not on screen, show the previous page
+  if (IsUpKey(key) && index > 0) {
+    return index - 1;
+  }
+  // first entry of the next page
+  if (IsPageDownKey(key) && first + this->PageSize < count) {
+    return first + this->PageSize;
+  }
+  // first entry of the previous page
+  if (IsPageUpKey(key) && first > 0) {
+    return first - this->PageSize;
+  }
+  return index;
+}
+
+void cmCursesMainForm::ShowEntry(std::string const& key)
+{
+  std::vector<size_t> const& rows = this->GetVisibleRows();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (rows[i] < this->Entries.size() &&
+        key == this->Entries[rows[i]].Key) {
+      this->ShowRow(i);
+      return;
     }
-    this->Fields[3 * j] = (*it)->Label->Field;
-    this->Fields[3 * j + 1] = (*it)->IsNewLabel->Field;
-    this->Fields[3 * j + 2] = (*it)->Entry->Field;
-    j++;
-  }
-  // if no cache entries there should still be one dummy field
-  if (j == 0) {
-    it = this->Entries->begin();
-    this->Fields[0] = (*it)->Label->Field;
-    this->Fields[1] = (*it)->IsNewLabel->Field;
-    this->Fields[2] = (*it)->Entry->Field;
-    this->NumberOfVisibleEntries = 1;
   }
-  // Has to be null terminated.
-  this->Fields[3 * this->NumberOfVisibleEntries] = CM_NULLPTR;
+}
+
+cmCursesCacheEntryComposite* cmCursesMainForm::CreatePlaceholder(
+  const char* label)
+{
+  cmCursesCacheEntryComposite* entry =
+    new cmCursesCacheEntryComposite(label, 30, 30);
+  delete entry->Entry;
+  entry->Entry = new cmCursesDummyWidget(1, 1, 1, 1);
+  return entry;
 }
 
 void cmCursesMainForm::Render(int left, int top, int width, int height)
 {
+  cmTraceScope scope("Render");
+
+  // The cache may have arrived while another form was shown.
+  this->FinishConfigure();
 
+  // The current row keeps its widget, which may be running its input
+  // loop, as when the terminal is resized during an edit.
+  std::vector<size_t> const& rows = this->GetVisibleRows();
+  size_t currentIndex = rows.size();
   if (this->Form) {
+    currentIndex = this->GetCurrentIndex();
     FIELD* currentField = current_field(this->Form);
     cmCursesWidget* cw =
       reinterpret_cast<cmCursesWidget*>(field_userptr(currentField));
-    // If in edit mode, get out of it
+    // If in edit mode, get out of it, keeping what was typed
     if (cw->GetType() == cmStateEnums::STRING ||
         cw->GetType() == cmStateEnums::PATH ||
         cw->GetType() == cmStateEnums::FILEPATH) {
       cmCursesStringWidget* sw = static_cast<cmCursesStringWidget*>(cw);
+      if (sw->GetInEdit()) {
+        form_driver(this->Form, REQ_VALIDATION);
+      }
       sw->SetInEdit(false);
     }
     // Delete the previous form
-    unpost_form(this->Form);
-    free_form(this->Form);
-    this->Form = CM_NULLPTR;
+    this->FreeForm();
   }
+  size_t const currentRow =
+    currentIndex < rows.size() ? rows[currentIndex] : this->Entries.size();
 
   // Wrong window size
   if (width < cmCursesMainForm::MIN_WIDTH || width < this->InitialWidth ||
@@ -271,64 +583,126 @@ void cmCursesMainForm::Render(int left, int top, int width, int height)
   // Leave room for toolbar
   height -= 7;
 
-  if (this->AdvancedMode) {
-    this->NumberOfVisibleEntries = this->Entries->size();
-  } else {
-    // If normal, display only non-advanced entries
-    this->NumberOfVisibleEntries = 0;
-    std::vector<cmCursesCacheEntryComposite*>::iterator it;
-    for (it = this->Entries->begin(); it != this->Entries->end(); ++it) {
-      const char* existingValue =
-        this->CMakeInstance->GetState()->GetCacheEntryValue((*it)->GetValue());
-      bool advanced =
-        this->CMakeInstance->GetState()->GetCacheEntryPropertyAsBool(
-          (*it)->GetValue(), "ADVANCED");
-      if (!existingValue || (!this->AdvancedMode && advanced)) {
-        continue;
-      }
-      this->NumberOfVisibleEntries++;
+  this->NumberOfVisibleEntries = rows.size();
+
+  // Only the rows on screen get widgets.  Keep the ones that are still
+  // on screen, release the others.  When the page size changes, show
+  // the page of the current row.
+  size_t const pageSize = static_cast<size_t>(std::max(height, 1));
+  if (pageSize != this->PageSize && currentIndex < rows.size()) {
+    this->FirstRow = currentIndex;
+  }
+  this->PageSize = pageSize;
+  if (this->FirstRow >= rows.size()) {
+    this->FirstRow = rows.empty() ? 0 : rows.size() - 1;
+  }
+  this->FirstRow -= this->FirstRow % this->PageSize;
+  this->NumberOfPages = std::max(
+    1, static_cast<int>((rows.size() + this->PageSize - 1) / this->PageSize));
+  size_t const lastRow =
+    std::min(rows.size(), this->FirstRow + this->PageSize);
+
+  std::vector<size_t> live;
+  std::vector<TreeNode*> liveGroups;
+  for (size_t i = this->FirstRow; i < lastRow; ++i) {
+    if (rows[i] < this->Entries.size()) {
+      live.push_back(rows[i]);
+    } else {
+      liveGroups.push_back(&this->GetGroupNode(rows[i]));
     }
   }
+  // If no entry is visible, show the first one anyway, unless none
+  // matches the filter.
+  if (rows.empty() && !this->Entries.empty() && !this->IsFiltered()) {
+    live.push_back(0);
+  }
+  if (currentRow < this->Entries.size() &&
+      std::find(live.begin(), live.end(), currentRow) == live.end()) {
+    live.push_back(currentRow);
+  }
+  int entrywidth = this->InitialWidth - 35;
+  for (size_t row : live) {
+    EntryRow& entry = this->Entries[row];
+    if (!entry.Composite) {
+      entry.Composite = new cmCursesCacheEntryComposite(
+        entry.Id, this->CMakeInstance, entry.IsNew, 30, entrywidth);
+    }
+  }
+  for (size_t row : this->LiveRows) {
+    if (std::find(live.begin(), live.end(), row) == live.end()) {
+      delete this->Entries[row].Composite;
+      this->Entries[row].Composite = CM_NULLPTR;
+    }
+  }
+  this->LiveRows.swap(live);
+  for (TreeNode* node : liveGroups) {
+    if (!node->Header) {
+      this->CreateGroupHeader(*node);
+    }
+  }
+  for (TreeNode* node : this->LiveGroups) {
+    if (std::find(liveGroups.begin(), liveGroups.end(), node) ==
+        liveGroups.end()) {
+      delete node->Header;
+      node->Header = CM_NULLPTR;
+    }
+  }
+  this->LiveGroups.swap(liveGroups);
 
-  // Re-adjust the fields according to their place
-  this->NumberOfPages = 1;
-  if (height > 0) {
-    bool isNewPage;
-    int i = 0;
-    std::vector<cmCursesCacheEntryComposite*>::iterator it;
-    for (it = this->Entries->begin(); it != this->Entries->end(); ++it) {
-      const char* existingValue =
-        this->CMakeInstance->GetState()->GetCacheEntryValue((*it)->GetValue());
-      bool advanced =
-        this->CMakeInstance->GetState()->GetCacheEntryPropertyAsBool(
-          (*it)->GetValue(), "ADVANCED");
-      if (!existingValue || (!this->AdvancedMode && advanced)) {
-        continue;
+  // Assign the fields: 3 for each entry: label, new entry marker
+  // ('*' or ' ') and entry widget
+  std::vector<cmCursesCacheEntryComposite*> shown;
+  for (size_t i = this->FirstRow; i < lastRow; ++i) {
+    shown.push_back(this->GetRowEntry(rows[i]));
+  }
+  // there is always one even if it is the dummy one
+  if (shown.empty()) {
+    // If cache is empty, or nothing matches the filter, display a
+    // label saying so and a dummy entry widget (does not respond to
+    // input)
+    if (this->Entries.empty()) {
+      if (!this->EmptyEntry) {
+        this->EmptyEntry = CreatePlaceholder("EMPTY CACHE");
       }
-      int row = (i % height) + 1;
-      int page = (i / height) + 1;
-      isNewPage = (page > 1) && (row == 1);
-
-      if (isNewPage) {
-        this->NumberOfPages++;
+      shown.push_back(this->EmptyEntry);
+    } else if (this->IsFiltered()) {
+      if (!this->NoMatchEntry) {
+        this->NoMatchEntry = CreatePlaceholder("NO MATCHING ENTRIES");
       }
-      (*it)->Label->Move(left, top + row - 1, isNewPage);
-      (*it)->IsNewLabel->Move(left + 32, top + row - 1, false);
-      (*it)->Entry->Move(left + 33, top + row - 1, false);
-      (*it)->Entry->SetPage(this->NumberOfPages);
-      i++;
+      shown.push_back(this->NoMatchEntry);
+    } else {
+      shown.push_back(this->Entries[0].Composite);
     }
   }
+  delete[] this->Fields;
+  this->Fields = new FIELD*[3 * shown.size() + 1];
+  for (size_t j = 0; j < shown.size(); ++j) {
+    cmCursesCacheEntryComposite* entry = shown[j];
+    int const line = top + static_cast<int>(j);
+    entry->Label->Move(left, line, false);
+    entry->IsNewLabel->Move(left + 32, line, false);
+    entry->Entry->Move(left + 33, line, false);
+    this->Fields[3 * j] = entry->Label->Field;
+    this->Fields[3 * j + 1] = entry->IsNewLabel->Field;
+    this->Fields[3 * j + 2] = entry->Entry->Field;
+  }
+  // Has to be null terminated.
+  this->Fields[3 * shown.size()] = CM_NULLPTR;
 
-  // Post the form
+  // Post the form, on the same row as before if it is on the page
   this->Form = new_form(this->Fields);
+  if (currentIndex >= this->FirstRow && currentIndex < lastRow) {
+    set_current_field(
+      this->Form, this->Fields[3 * (currentIndex - this->FirstRow) + 2]);
+  }
   post_form(this->Form);
-  // Update toolbar
+  // Update toolbar; the screen may have been cleared since it was
+  // last drawn.
+  this->InvalidateToolbar();
   this->UpdateStatusBar();
   this->PrintKeys();
 
-  touchwin(stdscr);
-  refresh();
+  cmCursesScreen::Update();
 }
 
 void cmCursesMainForm::PrintKeys(int process /* = 0 */)
@@ -347,62 +721,99 @@ void cmCursesMainForm::PrintKeys(int process /* = 0 */)
     cw = reinterpret_cast<cmCursesWidget*>(field_userptr(currentField));
   }
 
-  char fmt_s[] = "%s";
-  if (cw == CM_NULLPTR || !cw->PrintKeys()) {
-    char firstLine[512] = "";
-    char secondLine[512] = "";
-    char thirdLine[512] = "";
-    if (process) {
-      const char* clearLine =
-        "                                                                    ";
-      strcpy(firstLine, clearLine);
-      strcpy(secondLine, clearLine);
-      strcpy(thirdLine, clearLine);
-    } else {
+  if (cw && cw->PrintKeys()) {
+    // The widget drew over the toolbar.
+    this->ToolbarLines.clear();
+  } else {
+    std::string lines[4];
+    if (!process) {
+      lines[0] = "Press [enter] to edit option Press [d] to delete an entry";
+      lines[1] = "Press [c] to configure       ";
       if (this->OkToGenerate) {
-        sprintf(firstLine,
-                "Press [c] to configure       Press [g] to generate and exit");
-      } else {
-        sprintf(firstLine,
-                "Press [c] to configure                                     ");
+        lines[1] += "Press [g] to generate and exit";
       }
-      {
-        const char* toggleKeyInstruction =
-          "Press [t] to toggle advanced mode (Currently %s)";
-        sprintf(thirdLine, toggleKeyInstruction,
-                this->AdvancedMode ? "On" : "Off");
-      }
-      sprintf(secondLine, "Press [h] for help           "
-                          "Press [q] to quit without generating");
+      lines[2] = "Press [h] for help           "
+                 "Press [q] to quit without generating";
+      lines[3] = "Press [t] to toggle advanced mode (Currently ";
+      lines[3] += this->AdvancedMode ? "On)" : "Off)";
     }
-
-    curses_move(y - 4, 0);
-    char fmt[512] =
-      "Press [enter] to edit option Press [d] to delete an entry";
-    if (process) {
-      strcpy(fmt, "                           ");
+    // The CMake version goes on the right of the first line.
+    std::string const version =
+      std::string("CMake Version ") + cmVersion::GetCMakeVersion();
+    size_t const width = static_cast<size_t>(x);
+    if (lines[0].size() + version.size() < width) {
+      lines[0].resize(width - version.size(), ' ');
+      lines[0] += version;
+    }
+    for (int i = 0; i < 4; ++i) {
+      this->DrawToolbarLine(i + 1, lines[i]);
     }
-    printw(fmt_s, fmt);
-    curses_move(y - 3, 0);
-    printw(fmt_s, firstLine);
-    curses_move(y - 2, 0);
-    printw(fmt_s, secondLine);
-    curses_move(y - 1, 0);
-    printw(fmt_s, thirdLine);
   }
 
   if (cw) {
-    char pageLine[512] = "";
-    sprintf(pageLine, "Page %d of %d", cw->GetPage(), this->NumberOfPages);
-    curses_move(0, 65 - static_cast<unsigned int>(strlen(pageLine)) - 1);
-    printw(fmt_s, pageLine);
+    char pageLine[64];
+    sprintf(pageLine, "Page %d of %d",
+            static_cast<int>(this->FirstRow / this->PageSize) + 1,
+            this->NumberOfPages);
+    if (this->IsFiltered() && !this->FilterMode) {
+      sprintf(pageLine, "Filtered (%lu)  Page %d of %d",
+              static_cast<unsigned long>(this->NumberOfVisibleEntries),
+              static_cast<int>(this->FirstRow / this->PageSize) + 1,
+              this->NumberOfPages);
+    }
+    if (this->PageLine != pageLine) {
+      // Right aligned, clear what is left of a longer previous one.
+      std::string line(pageLine);
+      if (line.size() < this->PageLine.size()) {
+        line.insert(0, this->PageLine.size() - line.size(), ' ');
+      }
+      char fmt_s[] = "%s";
+      curses_move(0, 64 - static_cast<unsigned int>(line.size()));
+      printw(fmt_s, line.c_str());
+      this->PageLine = pageLine;
+    }
   }
 
   pos_form_cursor(this->Form);
 }
 
-// Print the key of the current entry and the CMake version
-// on the status bar. Designed for a width of 80 chars.
+void cmCursesMainForm::DrawToolbarLine(int line, std::string text)
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  if (this->ToolbarLines.size() !=
+      static_cast<size_t>(NUMBER_OF_TOOLBAR_LINES)) {
+    // Nothing is known to be on the toolbar.  Lines are padded to the
+    // width of the screen, so an empty one never matches.
+    this->ToolbarLines.assign(NUMBER_OF_TOOLBAR_LINES, std::string());
+  }
+  // Pad or truncate to the width of the screen; leave the last column
+  // of the last line alone, writing there would scroll the screen.
+  size_t const width = static_cast<size_t>(x);
+  text.resize(line + 1 < NUMBER_OF_TOOLBAR_LINES ? width : width - 1, ' ');
+  if (this->ToolbarLines[line] == text) {
+    return;
+  }
+  curses_move(y - NUMBER_OF_TOOLBAR_LINES + line, 0);
+  // The first line is the status bar.
+  if (line == 0) {
+    attron(A_STANDOUT);
+  }
+  addnstr(text.c_str(), static_cast<int>(text.size()));
+  if (line == 0) {
+    attroff(A_STANDOUT);
+  }
+  this->ToolbarLines[line].swap(text);
+}
+
+void cmCursesMainForm::InvalidateToolbar()
+{
+  this->ToolbarLines.clear();
+  this->PageLine.clear();
+}
+
+// Print the key of the current entry, or the message, on the status
+// bar.
 void cmCursesMainForm::UpdateStatusBar(const char* message)
 {
   int x, y;
@@ -411,112 +822,45 @@ void cmCursesMainForm::UpdateStatusBar(const char* message)
   if (x < cmCursesMainForm::MIN_WIDTH || x < this->InitialWidth ||
       y < cmCursesMainForm::MIN_HEIGHT) {
     curses_clear();
+    this->InvalidateToolbar();
     curses_move(0, 0);
     char fmt[] = "Window is too small. A size of at least %dx%d is required.";
     printw(fmt, (cmCursesMainForm::MIN_WIDTH < this->InitialWidth
                    ? this->InitialWidth
                    : cmCursesMainForm::MIN_WIDTH),
            cmCursesMainForm::MIN_HEIGHT);
-    touchwin(stdscr);
-    wrefresh(stdscr);
+    cmCursesScreen::Update();
     return;
   }
 
-  // Get the key of the current entry
-  FIELD* cur = current_field(this->Form);
-  int findex = field_index(cur);
-  cmCursesWidget* lbl = CM_NULLPTR;
-  if (findex >= 0) {
-    lbl = reinterpret_cast<cmCursesWidget*>(
-      field_userptr(this->Fields[findex - 2]));
-  }
-  char help[128] = "";
-  const char* curField = "";
-  if (lbl) {
-    curField = lbl->GetValue();
-
-    // Get the help string of the current entry
-    // and add it to the help string
-    const char* existingValue =
-      this->CMakeInstance->GetState()->GetCacheEntryValue(curField);
-    if (existingValue) {
-      const char* hs = this->CMakeInstance->GetState()->GetCacheEntryProperty(
-        curField, "HELPSTRING");
-      if (hs) {
-        strncpy(help, hs, 127);
-        help[127] = '\0';
-      } else {
-        help[0] = 0;
-      }
-    } else {
-      sprintf(help, " ");
-    }
-  }
-
-  // Join the key, help string and pad with spaces
-  // (or truncate) as necessary
-  char bar[cmCursesMainForm::MAX_WIDTH];
-  size_t i, curFieldLen = strlen(curField);
-  size_t helpLen = strlen(help);
-
-  size_t width;
-  if (x < cmCursesMainForm::MAX_WIDTH) {
-    width = x;
-  } else {
-    width = cmCursesMainForm::MAX_WIDTH;
-  }
-
+  std::string bar;
   if (message) {
-    curField = message;
-    curFieldLen = strlen(message);
-    if (curFieldLen < width) {
-      strcpy(bar, curField);
-      for (i = curFieldLen; i < width; ++i) {
-        bar[i] = ' ';
-      }
-    } else {
-      strncpy(bar, curField, width);
-    }
+    bar = message;
   } else {
-    if (curFieldLen >= width) {
-      strncpy(bar, curField, width);
-    } else {
-      strcpy(bar, curField);
-      bar[curFieldLen] = ':';
-      bar[curFieldLen + 1] = ' ';
-      if (curFieldLen + helpLen + 2 >= width) {
-        strncpy(bar + curFieldLen + 2, help, width - curFieldLen - 2);
-      } else {
-        strcpy(bar + curFieldLen + 2, help);
-        for (i = curFieldLen + helpLen + 2; i < width; ++i) {
-          bar[i] = ' ';
+    // Get the key of the current entry
+    FIELD* cur = current_field(this->Form);
+    int findex = field_index(cur);
+    cmCursesWidget* lbl = CM_NULLPTR;
+    if (findex >= 0) {
+      lbl = reinterpret_cast<cmCursesWidget*>(
+        field_userptr(this->Fields[findex - 2]));
+    }
+    if (lbl) {
+      bar = lbl->GetValue();
+      bar += ": ";
+      // Add the help string of the current entry
+      cmState const* state = this->CMakeInstance->GetState();
+      cmState::EntryId const id = state->FindCacheEntry(lbl->GetValue());
+      if (id != cmState::InvalidEntry) {
+        const char* hs =
+          state->GetCacheEntryProperty(id, cmStateEnums::HELPSTRING);
+        if (hs) {
+          bar += hs;
         }
       }
     }
   }
-
-  bar[width] = '\0';
-
-  // Display CMake version info on the next line
-  // We want to display this on the right
-  char version[cmCursesMainForm::MAX_WIDTH];
-  char vertmp[128];
-  sprintf(vertmp, "CMake Version %s", cmVersion::GetCMakeVersion());
-  size_t sideSpace = (width - strlen(vertmp));
-  for (i = 0; i < sideSpace; i++) {
-    version[i] = ' ';
-  }
-  sprintf(version + sideSpace, "%s", vertmp);
-  version[width] = '\0';
-
-  // Now print both lines
-  char fmt_s[] = "%s";
-  curses_move(y - 5, 0);
-  attron(A_STANDOUT);
-  printw(fmt_s, bar);
-  attroff(A_STANDOUT);
-  curses_move(y - 4, 0);
-  printw(fmt_s, version);
+  this->DrawToolbarLine(0, bar);
   pos_form_cursor(this->Form);
 }
 
@@ -536,20 +880,19 @@ void cmCursesMainForm::UpdateProgress(const char* msg, float prog, void* vp)
   cm->UpdateStatusBar(cmsg);
   cm->PrintKeys(1);
   curses_move(1, 1);
-  touchwin(stdscr);
-  refresh();
+  cmCursesScreen::Update();
 }
 
 int cmCursesMainForm::Configure(int noconfigure)
 {
+  cmTraceScope scope("Configure");
   int xi, yi;
   getmaxyx(stdscr, yi, xi);
 
   curses_move(1, 1);
   this->UpdateStatusBar("Configuring, please wait...");
   this->PrintKeys(1);
-  touchwin(stdscr);
-  refresh();
+  cmCursesScreen::Update();
   this->CMakeInstance->SetProgressCallback(cmCursesMainForm::UpdateProgress,
                                            this);
 
@@ -572,10 +915,23 @@ int cmCursesMainForm::Configure(int noconfigure)
       retVal = 0;
     }
   } else {
-    retVal = this->CMakeInstance->Configure();
+    // Configuring replaces the cache, make that undoable
+    this->PushUndo();
+    this->ConfigureBefore =
+      cmCacheDiff::ListEntries(*this->CMakeInstance->GetState());
+    // The cache is loaded while the user interface waits for keys,
+    // unless keys are read without running the loop.
+    retVal = this->CMakeInstance->Configure(!cmCursesScreen::IsPolling());
+    this->LoadingCache = true;
   }
   this->CMakeInstance->SetProgressCallback(CM_NULLPTR, CM_NULLPTR);
 
+  // The composites refer to entries by id, rebuild them before
+  // anything is rendered again.
+  if (!this->FinishConfigure() && !this->LoadingCache) {
+    this->InitializeUI();
+  }
+
   keypad(stdscr, true); /* Use key symbols as KEY_DOWN */
 
   if (retVal != 0 || !this->Errors.empty()) {
@@ -603,22 +959,45 @@ int cmCursesMainForm::Configure(int noconfigure)
     this->Render(1, 1, xx, yy);
   }
 
-  this->InitializeUI();
   this->Render(1, 1, xi, yi);
 
   return 0;
 }
 
+bool cmCursesMainForm::FinishConfigure()
+{
+  if (!this->LoadingCache || this->CMakeInstance->IsLoadingCache()) {
+    return false;
+  }
+  this->LoadingCache = false;
+  cmCacheDiff::EntryList const before = std::move(this->ConfigureBefore);
+  this->ConfigureBefore.clear();
+  cmCacheDiff::EntryList const after =
+    cmCacheDiff::ListEntries(*this->CMakeInstance->GetState());
+  this->ConfigureChanges =
+    cmCacheDiff::Format(cmCacheDiff::Compute(before, after), before, after);
+  this->InitializeUI();
+  return true;
+}
+
+void cmCursesMainForm::CacheLoaded(void* vp)
+{
+  // Only a cache that arrives while keys are waited for needs a wake.
+  if (static_cast<cmCursesMainForm*>(vp)->LoadingCache) {
+    cmCursesScreen::Wake();
+  }
+}
+
 int cmCursesMainForm::Generate()
 {
+  cmTraceScope scope("Generate");
   int xi, yi;
   getmaxyx(stdscr, yi, xi);
 
   curses_move(1, 1);
   this->UpdateStatusBar("Generating, please wait...");
   this->PrintKeys(1);
-  touchwin(stdscr);
-  refresh();
+  cmCursesScreen::Update();
   this->CMakeInstance->SetProgressCallback(cmCursesMainForm::UpdateProgress,
                                            this);
 
@@ -675,12 +1054,35 @@ void cmCursesMainForm::RemoveEntry(const char* value)
     return;
   }
 
-  std::vector<cmCursesCacheEntryComposite*>::iterator it;
-  for (it = this->Entries->begin(); it != this->Entries->end(); ++it) {
-    const char* val = (*it)->GetValue();
-    if (val && !strcmp(value, val)) {
+  for (size_t row = 0; row < this->Entries.size(); ++row) {
+    if (!strcmp(value, this->Entries[row].Key)) {
       this->CMakeInstance->UnwatchUnusedCli(value);
-      this->Entries->erase(it);
+      // The fields of the entry must not be part of a form when it is
+      // deleted.
+      this->FreeForm();
+      delete this->Entries[row].Composite;
+      RemoveVisibleRow(this->LiveRows, row);
+      RemoveVisibleRow(this->NormalRows, row);
+      RemoveVisibleRow(this->AdvancedRows, row);
+      for (std::vector<size_t>& rows : this->FilterRows) {
+        RemoveVisibleRow(rows, row);
+      }
+      // The ranked rows are not sorted.
+      auto ranked = std::find(this->RankedRows.begin(),
+                              this->RankedRows.end(), row);
+      if (ranked != this->RankedRows.end()) {
+        this->RankedRows.erase(ranked);
+      }
+      for (size_t& other : this->RankedRows) {
+        if (other > row) {
+          --other;
+        }
+      }
+      this->Entries.erase(this->Entries.begin() + row);
+      this->ClearTrees();
+      if (this->TreeMode) {
+        this->UpdateTreeRows();
+      }
       break;
     }
   }
@@ -689,46 +1091,104 @@ void cmCursesMainForm::RemoveEntry(const char* value)
 // copy from the list box to the cache manager
 void cmCursesMainForm::FillCacheManagerFromUI()
 {
-  size_t size = this->Entries->size();
-  for (size_t i = 0; i < size; i++) {
-    std::string cacheKey = (*this->Entries)[i]->Key;
-    const char* existingValue =
-      this->CMakeInstance->GetState()->GetCacheEntryValue(cacheKey);
-    if (existingValue) {
-      std::string oldValue = existingValue;
-      std::string newValue = (*this->Entries)[i]->Entry->GetValue();
-      std::string fixedOldValue;
-      std::string fixedNewValue;
-      cmStateEnums::CacheEntryType t =
-        this->CMakeInstance->GetState()->GetCacheEntryType(cacheKey);
-      this->FixValue(t, oldValue, fixedOldValue);
-      this->FixValue(t, newValue, fixedNewValue);
-
-      if (!(fixedOldValue == fixedNewValue)) {
-        // The user has changed the value.  Mark it as modified.
-        this->CMakeInstance->GetState()->SetCacheEntryBoolProperty(
-          cacheKey, "MODIFIED", true);
-        this->CMakeInstance->GetState()->SetCacheEntryValue(cacheKey,
-                                                            fixedNewValue);
+  // Entries that are not on screen have no widgets that could hold
+  // changes.
+  for (size_t row : this->LiveRows) {
+    this->CommitEntry(this->Entries[row].Composite);
+  }
+}
+
+void cmCursesMainForm::CommitEntry(cmCursesCacheEntryComposite* entry)
+{
+  cmState* state = this->CMakeInstance->GetState();
+  cmState::EntryId const id = entry->Id;
+  if (id >= state->GetNumberOfCacheEntries()) {
+    return;
+  }
+  // The canonical form of the old value was computed when it was set.
+  std::string const fixedNewValue = cmState::CanonicalCacheEntryValue(
+    state->GetCacheEntryType(id), entry->Entry->GetValue());
+
+  if (fixedNewValue != state->GetCacheEntryCanonicalValue(id)) {
+    // The user has changed the value.  Mark it as modified.
+    this->PushUndo();
+    state->SetCacheEntryFlag(id, cmState::FlagModified, true);
+    state->SetCacheEntryValue(id, fixedNewValue);
+  }
+}
+
+void cmCursesMainForm::PushUndo()
+{
+  if (this->UndoStack.size() == cmCursesMainForm::MAX_UNDO_LEVELS) {
+    this->UndoStack.erase(this->UndoStack.begin());
+  }
+  this->UndoStack.push_back(this->CMakeInstance->GetState()->TakeSnapshot());
+  this->RedoStack.clear();
+}
+
+void cmCursesMainForm::RestoreCache(std::vector<cmState::Snapshot>& from,
+                                    std::vector<cmState::Snapshot>& to)
+{
+  if (from.empty()) {
+    return;
+  }
+
+  // Remember the current entry, to return to it afterwards
+  std::string currentKey;
+  if (this->Form) {
+    int findex = field_index(current_field(this->Form));
+    if (findex >= 2) {
+      cmCursesWidget* lbl = reinterpret_cast<cmCursesWidget*>(
+        field_userptr(this->Fields[findex - 2]));
+      if (lbl) {
+        currentKey = lbl->GetValue();
       }
     }
   }
+
+  cmState* state = this->CMakeInstance->GetState();
+  to.push_back(state->TakeSnapshot());
+  state->RestoreSnapshot(from.back());
+  from.pop_back();
+  this->MarkServerChanges();
+  this->OkToGenerate = false;
+
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  this->CreateEntries();
+  this->Render(1, 1, x, y);
+  this->ShowEntry(currentKey);
 }
 
-void cmCursesMainForm::FixValue(cmStateEnums::CacheEntryType type,
-                                const std::string& in, std::string& out) const
+void cmCursesMainForm::MarkServerChanges()
 {
-  out = in.substr(0, in.find_last_not_of(' ') + 1);
-  if (type == cmStateEnums::PATH || type == cmStateEnums::FILEPATH) {
-    cmSystemTools::ConvertToUnixSlashes(out);
-  }
-  if (type == cmStateEnums::BOOL) {
-    if (cmSystemTools::IsOff(out.c_str())) {
-      out = "OFF";
-    } else {
-      out = "ON";
+  cmState* state = this->CMakeInstance->GetState();
+  cmState::Snapshot const& server = this->ServerCache;
+  bool const sameIds = state->HasSameLayout(server);
+
+  // A restored state may come from before the last configure step, or
+  // have lost edits made since the one it was taken in.
+  cmState::EntryId const numberOfEntries =
+    static_cast<cmState::EntryId>(state->GetNumberOfCacheEntries());
+  for (cmState::EntryId id = 0; id < numberOfEntries; ++id) {
+    if (state->GetCacheEntryFlag(id, cmState::FlagRemoved)) {
+      continue;
     }
+    cmState::EntryId const serverId =
+      sameIds ? id : server.FindCacheEntry(state->GetCacheEntryKey(id));
+    bool const modified = serverId == cmState::InvalidEntry ||
+      strcmp(state->GetCacheEntryCanonicalValue(id),
+             server.GetCacheEntryCanonicalValue(serverId)) != 0;
+    if (modified != state->GetCacheEntryFlag(id, cmState::FlagModified)) {
+      state->SetCacheEntryFlag(id, cmState::FlagModified, modified);
+    }
+  }
+  if (sameIds) {
+    return;
   }
+
+  // Entries that cmake has must exist to be removed.
+  state->AddRemovedCacheEntries(server);
 }
 
 void cmCursesMainForm::HandleInput()
@@ -741,24 +1201,48 @@ void cmCursesMainForm::HandleInput()
 
   FIELD* currentField;
   cmCursesWidget* currentWidget;
-
-  char debugMessage[128];
+  // Whether the last key was dropped because the cache is loading.
+  bool blocked = false;
+  // The span of a key lasts until the terminal shows what it did.
+  std::unique_ptr<cmTraceScope> keyScope;
 
   for (;;) {
-    this->UpdateStatusBar();
-    this->PrintKeys();
+    // Only the parts of the toolbar that changed are drawn, and the
+    // terminal gets one update per key.
     if (this->SearchMode) {
       std::string searchstr = "Search: " + this->SearchString;
       this->UpdateStatusBar(searchstr.c_str());
       this->PrintKeys(1);
       curses_move(y - 5, static_cast<unsigned int>(searchstr.size()));
-      // curses_move(1,1);
-      touchwin(stdscr);
-      refresh();
+    } else if (this->FilterMode) {
+      std::string const filterstr = "Filter: " + this->FilterString;
+      this->UpdateStatusBar(filterstr.c_str());
+      this->PrintKeys(1);
+      curses_move(y - 5, static_cast<unsigned int>(filterstr.size()));
+    } else if (this->LoadingCache) {
+      this->UpdateStatusBar(
+        blocked ? "Only viewing keys work until the cache has loaded."
+                : "Loading the cache, please wait...");
+      this->PrintKeys(1);
+    } else {
+      this->UpdateStatusBar();
+      this->PrintKeys();
     }
-    int key = getch();
+    cmCursesScreen::Update();
+    keyScope.reset();
+    int key = cmCursesScreen::GetKey();
+    if (cmTrace::IsEnabled()) {
+      keyScope.reset(new cmTraceScope("HandleInput", "key", key));
+    }
+    blocked = false;
 
     getmaxyx(stdscr, y, x);
+    if (this->FinishConfigure()) {
+      this->Render(1, 1, x, y);
+    }
+    if (key == KEY_REFRESH) {
+      continue;
+    }
     // If window too small, handle 'q' only
     if (x < cmCursesMainForm::MIN_WIDTH || y < cmCursesMainForm::MIN_HEIGHT) {
       // quit
@@ -800,70 +1284,63 @@ void cmCursesMainForm::HandleInput()
           this->SearchString.resize(this->SearchString.size() - 1);
         }
       }
-    } else if (currentWidget && !this->SearchMode) {
+    } else if (this->FilterMode) {
+      this->HandleFilterKey(key);
+    } else if (currentWidget && !this->LoadingCache) {
       // Ask the current widget if it wants to handle input
       widgetHandled = currentWidget->HandleInput(key, this, stdscr);
+      // Every completed edit goes to the cache right away, so that it
+      // can be undone.
+      for (size_t row : this->LiveRows) {
+        if (this->Entries[row].Composite->Entry == currentWidget) {
+          this->CommitEntry(this->Entries[row].Composite);
+          break;
+        }
+      }
       if (widgetHandled) {
         this->OkToGenerate = false;
         this->UpdateStatusBar();
         this->PrintKeys();
       }
     }
-    if ((!currentWidget || !widgetHandled) && !this->SearchMode) {
+    if ((!currentWidget || !widgetHandled) && !this->SearchMode &&
+        !this->FilterMode) {
       // If the current widget does not want to handle input,
       // we handle it.
-      sprintf(debugMessage, "Main form handling input, key: %d", key);
-      cmCursesForm::LogMessage(debugMessage);
+      cmLogger::Log(cmLogger::LevelTrace,
+                    "Main form handling input, key: %d", key);
       // quit
       if (key == 'q') {
         break;
       }
-      // if not end of page, next field otherwise next page
-      // each entry consists of fields: label, isnew, value
-      // therefore, the label field for the prev. entry is index-5
-      // and the label field for the next entry is index+1
-      // (index always corresponds to the value field)
-      // scroll down with arrow down, ctrl+n (emacs binding), or j (vim
-      // binding)
-      if (key == KEY_DOWN || key == ctrl('n') || key == 'j') {
-        FIELD* cur = current_field(this->Form);
-        size_t findex = field_index(cur);
-        if (findex == 3 * this->NumberOfVisibleEntries - 1) {
-          continue;
-        }
-        if (new_page(this->Fields[findex + 1])) {
-          form_driver(this->Form, REQ_NEXT_PAGE);
-        } else {
-          form_driver(this->Form, REQ_NEXT_FIELD);
-        }
+      // the entries shown are replaced when the cache arrives, until
+      // then they can only be looked at
+      blocked = this->LoadingCache && !IsViewingKey(key);
+      if (blocked) {
+        continue;
       }
-      // if not beginning of page, previous field, otherwise previous page
-      // each entry consists of fields: label, isnew, value
-      // therefore, the label field for the prev. entry is index-5
-      // and the label field for the next entry is index+1
-      // (index always corresponds to the value field)
-      // scroll down with arrow up, ctrl+p (emacs binding), or k (vim binding)
-      else if (key == KEY_UP || key == ctrl('p') || key == 'k') {
-        FIELD* cur = current_field(this->Form);
-        int findex = field_index(cur);
-        if (findex == 2) {
-          continue;
+      // move between entries and pages; the moves that are already
+      // waiting, as from a key held down, are applied at once and
+      // the screen is drawn for the last one only
+      if (IsNavigationKey(key)) {
+        size_t index = this->GetCurrentIndex();
+        for (;;) {
+          index = this->MoveIndex(key, index);
+          nodelay(stdscr, true);
+          key = getch();
+          nodelay(stdscr, false);
+          if (key == ERR) {
+            break;
+          }
+          if (!IsNavigationKey(key)) {
+            ungetch(key);
+            break;
+          }
         }
-        if (new_page(this->Fields[findex - 2])) {
-          form_driver(this->Form, REQ_PREV_PAGE);
-          set_current_field(this->Form, this->Fields[findex - 3]);
-        } else {
-          form_driver(this->Form, REQ_PREV_FIELD);
+        if (index != this->GetCurrentIndex()) {
+          this->ShowRow(index);
         }
       }
-      // pg down
-      else if (key == KEY_NPAGE || key == ctrl('d')) {
-        form_driver(this->Form, REQ_NEXT_PAGE);
-      }
-      // pg up
-      else if (key == KEY_PPAGE || key == ctrl('u')) {
-        form_driver(this->Form, REQ_PREV_PAGE);
-      }
       // configure
       else if (key == 'c') {
         this->Configure();
@@ -879,11 +1356,11 @@ void cmCursesMainForm::HandleInput()
         const char* curField = lbl->GetValue();
         const char* helpString = CM_NULLPTR;
 
-        const char* existingValue =
-          this->CMakeInstance->GetState()->GetCacheEntryValue(curField);
-        if (existingValue) {
-          helpString = this->CMakeInstance->GetState()->GetCacheEntryProperty(
-            curField, "HELPSTRING");
+        cmState const* state = this->CMakeInstance->GetState();
+        cmState::EntryId const id = state->FindCacheEntry(curField);
+        if (id != cmState::InvalidEntry) {
+          helpString =
+            state->GetCacheEntryProperty(id, cmStateEnums::HELPSTRING);
         }
         if (helpString) {
           char* message = new char
@@ -907,8 +1384,9 @@ void cmCursesMainForm::HandleInput()
         msgs->Render(1, 1, x, y);
         msgs->HandleInput();
         CurrentForm = this;
+        // Render keeps the current entry; the cache may have arrived
+        // meanwhile, which replaces the fields.
         this->Render(1, 1, x, y);
-        set_current_field(this->Form, cur);
       }
       // display last errors
       else if (key == 'l') {
@@ -920,17 +1398,69 @@ void cmCursesMainForm::HandleInput()
         msgs->HandleInput();
         CurrentForm = this;
         this->Render(1, 1, x, y);
+      }
+      // show what the last configure changed
+      else if (key == 'w') {
+        this->ShowConfigureChanges();
+      }
+      // compare with the cache of another build tree
+      else if (key == 'x') {
+        this->CompareWithBuildDirectory();
+      }
+      // show the configure profile
+      else if (key == 'p') {
+        this->ShowProfile();
+      }
+      // edit a list value element by element
+      else if (key == 'e' && this->NumberOfVisibleEntries &&
+               !this->GetCurrentGroup()) {
+        this->EditList();
+      }
+      // move the paths under a directory to another one
+      else if (key == 'r') {
+        this->RelocatePaths();
+      }
+      // undo the last edit or configure
+      else if (key == 'u') {
+        this->RestoreCache(this->UndoStack, this->RedoStack);
+      }
+      // redo what was undone
+      else if (key == ctrl('r')) {
+        this->RestoreCache(this->RedoStack, this->UndoStack);
       } else if (key == '/') {
         this->SearchMode = true;
-        this->UpdateStatusBar("Search");
-        this->PrintKeys(1);
-        touchwin(stdscr);
-        refresh();
       } else if (key == 'n') {
         if (!this->OldSearchString.empty()) {
           this->JumpToCacheEntry(this->OldSearchString.c_str());
         }
       }
+      // narrow the list as the filter is typed
+      else if (key == 'f') {
+        if (!this->RankedQuery.empty()) {
+          this->ClearFilters();
+          getmaxyx(stdscr, y, x);
+          this->RePost();
+          this->Render(1, 1, x, y);
+        }
+        this->FilterMode = true;
+      }
+      // list the entries that best match a query
+      else if (key == '?') {
+        std::string query = this->RankedQuery;
+        if (this->PromptString("Find: ", query)) {
+          this->RankEntries(query);
+        }
+        getmaxyx(stdscr, y, x);
+        this->RePost();
+        this->Render(1, 1, x, y);
+      }
+      // esc: show all entries again
+      else if (key == 27 && this->IsFiltered()) {
+        this->ClearFilters();
+        getmaxyx(stdscr, y, x);
+        this->RePost();
+        this->Render(1, 1, x, y);
+      }
       // switch advanced on/off
       else if (key == 't') {
         if (this->AdvancedMode) {
@@ -939,9 +1469,28 @@ void cmCursesMainForm::HandleInput()
           this->AdvancedMode = true;
         }
         getmaxyx(stdscr, y, x);
+        this->UpdateFilter();
+        if (this->TreeMode) {
+          this->UpdateTreeRows();
+        }
         this->RePost();
         this->Render(1, 1, x, y);
       }
+      // switch between the list and the tree of entries
+      else if (key == 'v') {
+        this->TreeMode = !this->TreeMode;
+        if (this->TreeMode) {
+          this->UpdateTreeRows();
+        }
+        getmaxyx(stdscr, y, x);
+        this->RePost();
+        this->Render(1, 1, x, y);
+      }
+      // open or close a group of the tree
+      else if ((key == 10 || key == KEY_ENTER || key == ' ') &&
+               this->GetCurrentGroup()) {
+        this->ToggleCurrentGroup();
+      }
       // generate and exit
       else if (key == 'g') {
         if (this->OkToGenerate) {
@@ -950,67 +1499,32 @@ void cmCursesMainForm::HandleInput()
         }
       }
       // delete cache entry
-      else if (key == 'd' && this->NumberOfVisibleEntries) {
+      else if (key == 'd' && this->NumberOfVisibleEntries &&
+               !this->GetCurrentGroup()) {
         this->OkToGenerate = false;
-        FIELD* cur = current_field(this->Form);
-        size_t findex = field_index(cur);
-
-        // make the next or prev. current field after deletion
-        // each entry consists of fields: label, isnew, value
-        // therefore, the label field for the prev. entry is findex-5
-        // and the label field for the next entry is findex+1
-        // (findex always corresponds to the value field)
-        FIELD* nextCur;
-        if (findex == 2) {
-          nextCur = CM_NULLPTR;
-        } else if (findex == 3 * this->NumberOfVisibleEntries - 1) {
-          nextCur = this->Fields[findex - 5];
-        } else {
-          nextCur = this->Fields[findex + 1];
-        }
-
-        // Get the label widget
-        // each entry consists of fields: label, isnew, value
-        // therefore, the label field for the is findex-2
-        // (findex always corresponds to the value field)
-        cmCursesWidget* lbl = reinterpret_cast<cmCursesWidget*>(
-          field_userptr(this->Fields[findex - 2]));
-        if (lbl) {
-          this->CMakeInstance->GetState()->RemoveCacheEntry(lbl->GetValue());
-
-          std::string nextVal;
-          if (nextCur) {
-            nextVal =
-              (reinterpret_cast<cmCursesWidget*>(field_userptr(nextCur))
-                 ->GetValue());
+        std::vector<size_t> const& rows = this->GetVisibleRows();
+        size_t const index = this->GetCurrentIndex();
+        if (index < rows.size() && rows[index] < this->Entries.size()) {
+          // make the next or prev. entry current after deletion
+          std::string nextKey;
+          if (index + 1 < rows.size()) {
+            nextKey = this->GetRowKey(rows[index + 1]);
+          } else if (index > 0) {
+            nextKey = this->GetRowKey(rows[index - 1]);
           }
 
+          std::string const deletedKey = this->Entries[rows[index]].Key;
+          this->PushUndo();
+          this->CMakeInstance->GetState()->RemoveCacheEntry(deletedKey);
+
           getmaxyx(stdscr, y, x);
-          this->RemoveEntry(lbl->GetValue());
+          this->RemoveEntry(deletedKey.c_str());
           this->RePost();
           this->Render(1, 1, x, y);
-
-          if (nextCur) {
-            // make the next or prev. current field after deletion
-            nextCur = CM_NULLPTR;
-            std::vector<cmCursesCacheEntryComposite*>::iterator it;
-            for (it = this->Entries->begin(); it != this->Entries->end();
-                 ++it) {
-              if (nextVal == (*it)->Key) {
-                nextCur = (*it)->Entry->Field;
-              }
-            }
-
-            if (nextCur) {
-              set_current_field(this->Form, nextCur);
-            }
-          }
+          this->ShowEntry(nextKey);
         }
       }
     }
-
-    touchwin(stdscr);
-    wrefresh(stdscr);
   }
 }
 
@@ -1026,6 +1540,159 @@ int cmCursesMainForm::LoadCache(const char* /*unused*/)
   return r;
 }
 
+// Whether the text contains the needle, ignoring case.  The needle is
+// in lower case and not empty.
+static bool ContainsFolded(const char* text, std::string const& needle)
+{
+  if (!text) {
+    return false;
+  }
+  // Candidates for the first character are found with memchr, in
+  // either case; most entries do not contain it at all.
+  int const lower = static_cast<unsigned char>(needle[0]);
+  int const upper = toupper(lower);
+  size_t const length = needle.size();
+  const char* const end = text + strlen(text);
+  while (static_cast<size_t>(end - text) >= length) {
+    const char* next =
+      static_cast<const char*>(memchr(text, lower, end - text));
+    if (upper != lower) {
+      const char* const other = static_cast<const char*>(
+        memchr(text, upper, (next ? next : end) - text));
+      if (other) {
+        next = other;
+      }
+    }
+    if (!next || static_cast<size_t>(end - next) < length) {
+      return false;
+    }
+    size_t i = 1;
+    while (i < length &&
+           tolower(static_cast<unsigned char>(next[i])) ==
+             static_cast<unsigned char>(needle[i])) {
+      ++i;
+    }
+    if (i == length) {
+      return true;
+    }
+    text = next + 1;
+  }
+  return false;
+}
+
+bool cmCursesMainForm::RowMatches(size_t row, std::string const& needle) const
+{
+  cmState const* state = this->CMakeInstance->GetState();
+  cmState::EntryId const id = this->Entries[row].Id;
+  return ContainsFolded(this->Entries[row].Key, needle) ||
+    ContainsFolded(state->GetCacheEntryValue(id), needle) ||
+    ContainsFolded(state->GetCacheEntryProperty(id, cmStateEnums::HELPSTRING),
+                   needle);
+}
+
+void cmCursesMainForm::ExtendFilter(char c)
+{
+  cmTraceScope scope("ExtendFilter");
+  this->FilterString += c;
+  std::string needle;
+  for (char f : this->FilterString) {
+    needle += static_cast<char>(tolower(static_cast<unsigned char>(f)));
+  }
+  // A longer query only matches rows that matched the shorter one.
+  std::vector<size_t> const& candidates = this->FilterRows.empty()
+    ? (this->AdvancedMode ? this->AdvancedRows : this->NormalRows)
+    : this->FilterRows.back();
+  std::vector<size_t> rows;
+  for (size_t row : candidates) {
+    if (this->RowMatches(row, needle)) {
+      rows.push_back(row);
+    }
+  }
+  this->FilterRows.push_back(std::move(rows));
+}
+
+void cmCursesMainForm::UpdateFilter()
+{
+  std::string const filter = this->FilterString;
+  this->FilterString.clear();
+  this->FilterRows.clear();
+  for (char c : filter) {
+    this->ExtendFilter(c);
+  }
+  if (!this->RankedQuery.empty()) {
+    this->RankEntries(this->RankedQuery);
+  }
+}
+
+void cmCursesMainForm::RankEntries(std::string const& query)
+{
+  cmTraceScope scope("RankEntries");
+  this->ClearFilters();
+  if (cmCacheSearch::GetWords(query).empty()) {
+    return;
+  }
+  std::vector<size_t> const& rows =
+    this->AdvancedMode ? this->AdvancedRows : this->NormalRows;
+  std::unordered_map<cmState::EntryId, size_t> rowOfId;
+  rowOfId.reserve(rows.size());
+  for (size_t row : rows) {
+    rowOfId[this->Entries[row].Id] = row;
+  }
+  for (cmCacheSearch::Match const& match :
+       cmCacheSearch::Find(*this->CMakeInstance->GetState(), query)) {
+    auto it = rowOfId.find(match.Id);
+    if (it != rowOfId.end()) {
+      this->RankedRows.push_back(it->second);
+    }
+  }
+  this->RankedQuery = query;
+}
+
+void cmCursesMainForm::ClearFilters()
+{
+  this->FilterString.clear();
+  this->FilterRows.clear();
+  this->RankedQuery.clear();
+  this->RankedRows.clear();
+}
+
+void cmCursesMainForm::HandleFilterKey(int key)
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  // enter: keep the filter
+  if (key == 10 || key == KEY_ENTER) {
+    this->FilterMode = false;
+    return;
+  }
+  // move in the list of matches
+  if (key == KEY_DOWN || key == KEY_UP || key == KEY_NPAGE ||
+      key == KEY_PPAGE) {
+    this->ShowRow(this->MoveIndex(key, this->GetCurrentIndex()));
+    return;
+  }
+  // esc: drop the filter
+  if (key == 27) {
+    this->FilterMode = false;
+    this->FilterString.clear();
+    this->FilterRows.clear();
+  } else if (key == ctrl('h') || key == KEY_BACKSPACE || key == 127) {
+    if (this->FilterString.empty()) {
+      return;
+    }
+    this->FilterString.resize(this->FilterString.size() - 1);
+    this->FilterRows.pop_back();
+  } else if (key >= ' ' && key < 127 &&
+             this->FilterString.size() <
+               static_cast<std::string::size_type>(x - 10)) {
+    this->ExtendFilter(static_cast<char>(key));
+  } else {
+    return;
+  }
+  this->RePost();
+  this->Render(1, 1, x, y);
+}
+
 void cmCursesMainForm::JumpToCacheEntry(const char* astr)
 {
   std::string str;
@@ -1036,48 +1703,250 @@ void cmCursesMainForm::JumpToCacheEntry(const char* astr)
   if (str.empty()) {
     return;
   }
-  FIELD* cur = current_field(this->Form);
-  int start_index = field_index(cur);
-  int findex = start_index;
+  // Keys never contain a newline, so a match never spans two keys.
+  if (str.find('\n') != std::string::npos) {
+    return;
+  }
+  if (!this->KeyIndex.Valid) {
+    this->BuildKeyIndex();
+  }
+  std::vector<size_t> const& offsets = this->KeyIndex.Offsets;
+  if (offsets.empty()) {
+    return;
+  }
+  // Search the rows after the current one, wrapping around; the rows
+  // do not need to be on screen.
+  size_t const next = this->GetCurrentIndex() + 1;
+  std::string const& keys = this->KeyIndex.Keys;
+  size_t const from = next < offsets.size() ? offsets[next] : keys.size();
+  size_t pos = keys.find(str, from);
+  if (pos == std::string::npos) {
+    pos = keys.find(str);
+    if (pos == std::string::npos) {
+      return;
+    }
+  }
+  size_t const index = static_cast<size_t>(
+    std::upper_bound(offsets.begin(), offsets.end(), pos) - offsets.begin() -
+    1);
+  this->ShowRow(index);
+}
+
+void cmCursesMainForm::BuildKeyIndex()
+{
+  std::vector<size_t> const& rows = this->GetVisibleRows();
+  this->KeyIndex.Keys.clear();
+  this->KeyIndex.Offsets.clear();
+  this->KeyIndex.Offsets.reserve(rows.size());
+  for (size_t row : rows) {
+    this->KeyIndex.Offsets.push_back(this->KeyIndex.Keys.size());
+    for (const char* c = this->GetRowKey(row); *c; ++c) {
+      this->KeyIndex.Keys += static_cast<char>(
+        tolower(static_cast<unsigned char>(*c)));
+    }
+    this->KeyIndex.Keys += '\n';
+  }
+  this->KeyIndex.Valid = true;
+}
+
+bool cmCursesMainForm::PromptString(const char* prompt, std::string& str)
+{
+  int x, y;
   for (;;) {
-    if (!str.empty()) {
-      cmCursesWidget* lbl = CM_NULLPTR;
-      if (findex >= 0) {
-        lbl = reinterpret_cast<cmCursesWidget*>(
-          field_userptr(this->Fields[findex - 2]));
-      }
-      if (lbl) {
-        const char* curField = lbl->GetValue();
-        if (curField) {
-          std::string cfld = cmSystemTools::LowerCase(curField);
-          if (cfld.find(str) != std::string::npos && findex != start_index) {
-            break;
-          }
-        }
+    getmaxyx(stdscr, y, x);
+    std::string const line = prompt + str;
+    this->UpdateStatusBar(line.c_str());
+    this->PrintKeys(1);
+    curses_move(y - 5, static_cast<unsigned int>(line.size()));
+    cmCursesScreen::Update();
+
+    int key = cmCursesScreen::GetKey();
+    if (key == 10 || key == KEY_ENTER) {
+      return true;
+    }
+    // esc
+    if (key == 27) {
+      return false;
+    }
+    if (key == ctrl('h') || key == KEY_BACKSPACE || key == 127) {
+      if (!str.empty()) {
+        str.resize(str.size() - 1);
       }
+    } else if (key >= ' ' && key < 127 &&
+               line.size() < static_cast<std::string::size_type>(x - 1)) {
+      str += static_cast<char>(key);
     }
-    if (size_t(findex) >= 3 * this->NumberOfVisibleEntries - 1) {
-      set_current_field(this->Form, this->Fields[2]);
-    } else if (new_page(this->Fields[findex + 1])) {
-      form_driver(this->Form, REQ_NEXT_PAGE);
-    } else {
-      form_driver(this->Form, REQ_NEXT_FIELD);
+  }
+}
+
+void cmCursesMainForm::ShowConfigureChanges()
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  std::vector<std::string> report;
+  if (this->ConfigureChanges.empty()) {
+    report.push_back("No configure step has been run yet.");
+  } else {
+    report.push_back(this->ConfigureChanges);
+  }
+  cmCursesLongMessageForm* msgs =
+    new cmCursesLongMessageForm(report, "Changes made by the last configure.");
+  CurrentForm = msgs;
+  msgs->Render(1, 1, x, y);
+  msgs->HandleInput();
+  CurrentForm = this;
+  delete msgs;
+  this->Render(1, 1, x, y);
+}
+
+void cmCursesMainForm::CompareWithBuildDirectory()
+{
+  std::string dir;
+  if (!this->PromptString("Compare with build directory: ", dir) ||
+      dir.empty()) {
+    return;
+  }
+
+  std::vector<std::string> report;
+  std::string title;
+  cmCacheDiff::EntryList other;
+  if (cmCacheDiff::LoadCacheFile(dir, other)) {
+    cmCacheDiff::EntryList const current =
+      cmCacheDiff::ListEntries(*this->CMakeInstance->GetState());
+    report.push_back(cmCacheDiff::Format(
+      cmCacheDiff::Compute(current, other), current, other));
+    title = "Changes from this cache to " + dir + ".";
+  } else {
+    report.push_back("Could not read " + dir + "/CMakeCache.txt");
+    title = "Errors occurred while reading the other cache.";
+  }
+
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  cmCursesLongMessageForm* msgs =
+    new cmCursesLongMessageForm(report, title.c_str());
+  CurrentForm = msgs;
+  msgs->Render(1, 1, x, y);
+  msgs->HandleInput();
+  CurrentForm = this;
+  delete msgs;
+  this->Render(1, 1, x, y);
+}
+
+void cmCursesMainForm::RelocatePaths()
+{
+  std::string from;
+  if (!this->PromptString("Relocate paths under: ", from) || from.empty()) {
+    return;
+  }
+  cmState* state = this->CMakeInstance->GetState();
+  std::vector<cmState::EntryId> const ids =
+    state->FindCacheEntriesUnderPath(from);
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  if (ids.empty()) {
+    std::vector<std::string> report;
+    report.push_back("No path option lies under " + from);
+    cmCursesLongMessageForm* msgs =
+      new cmCursesLongMessageForm(report, "Nothing to relocate.");
+    CurrentForm = msgs;
+    msgs->Render(1, 1, x, y);
+    msgs->HandleInput();
+    CurrentForm = this;
+    delete msgs;
+    this->Render(1, 1, x, y);
+    return;
+  }
+  std::string to;
+  if (!this->PromptString("to: ", to) || to.empty()) {
+    return;
+  }
+
+  // Remember the current entry, to return to it afterwards
+  std::string currentKey;
+  int findex = field_index(current_field(this->Form));
+  if (findex >= 2) {
+    cmCursesWidget* lbl = reinterpret_cast<cmCursesWidget*>(
+      field_userptr(this->Fields[findex - 2]));
+    if (lbl) {
+      currentKey = lbl->GetValue();
     }
-    /*
-    char buffer[1024];
-    sprintf(buffer, "Line: %d != %d / %d\n", findex, idx,
-    this->NumberOfVisibleEntries);
-    touchwin(stdscr);
-    refresh();
-    this->UpdateStatusBar( buffer );
-    usleep(100000);
-    */
-    cur = current_field(this->Form);
-    findex = field_index(cur);
-    if (findex == start_index) {
-      break;
+  }
+
+  // The values found have the prefix in canonical form, without a
+  // trailing slash unless it is the root.
+  std::string const prefix =
+    cmState::CanonicalCacheEntryValue(cmStateEnums::PATH, from);
+  to = cmState::CanonicalCacheEntryValue(cmStateEnums::PATH, to);
+  this->PushUndo();
+  for (std::vector<cmState::EntryId>::const_iterator it = ids.begin();
+       it != ids.end(); ++it) {
+    std::string rest = state->GetCacheEntryCanonicalValue(*it);
+    rest.erase(0, prefix.size());
+    if (!rest.empty() && rest[0] != '/') {
+      rest.insert(0, 1, '/');
     }
+    if (!rest.empty() && to[to.size() - 1] == '/') {
+      rest.erase(0, 1);
+    }
+    state->SetCacheEntryValue(*it, to + rest);
+    state->SetCacheEntryFlag(*it, cmState::FlagModified, true);
+  }
+  this->OkToGenerate = false;
+
+  getmaxyx(stdscr, y, x);
+  this->CreateEntries();
+  this->Render(1, 1, x, y);
+  this->ShowEntry(currentKey);
+}
+
+void cmCursesMainForm::ShowProfile()
+{
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  std::vector<std::string> report;
+  report.push_back(this->CMakeInstance->GetProfiler().Report());
+  cmCursesLongMessageForm* msgs =
+    new cmCursesLongMessageForm(report, "Configure profile.");
+  CurrentForm = msgs;
+  msgs->Render(1, 1, x, y);
+  msgs->HandleInput();
+  CurrentForm = this;
+  delete msgs;
+  this->Render(1, 1, x, y);
+}
+
+void cmCursesMainForm::EditList()
+{
+  std::vector<size_t> const& rows = this->GetVisibleRows();
+  size_t const index = this->GetCurrentIndex();
+  if (index >= rows.size() || rows[index] >= this->Entries.size()) {
+    return;
+  }
+  cmCursesCacheEntryComposite* entry = this->Entries[rows[index]].Composite;
+  if (!entry || entry->Entry->GetType() == cmStateEnums::BOOL) {
+    return;
+  }
+
+  // The field buffer of the widget is padded, the state is not.
+  const char* value =
+    this->CMakeInstance->GetState()->GetCacheEntryValue(entry->Id);
+  int x, y;
+  getmaxyx(stdscr, y, x);
+  std::string const title = std::string("Elements of ") + entry->Key;
+  cmCursesListEditor* editor =
+    new cmCursesListEditor(value ? value : "", title.c_str());
+  CurrentForm = editor;
+  editor->Render(1, 1, x, y);
+  editor->HandleInput();
+  CurrentForm = this;
+  if (editor->IsModified()) {
+    entry->Entry->SetValue(editor->GetValue());
+    this->CommitEntry(entry);
+    this->OkToGenerate = false;
   }
+  delete editor;
+  this->Render(1, 1, x, y);
 }
 
 const char* cmCursesMainForm::s_ConstHelpMessage =
@@ -1137,8 +2006,28 @@ const char* cmCursesMainForm::s_ConstHelpMessage =
   " g : generate build files and exit, only available when there are no "
   "new options and no errors have been detected during last configuration.\n"
   " l : shows last errors\n"
+  " w : shows the cache entries changed by the last configure\n"
+  " x : compares the cache with the one of another build directory\n"
+  " p : shows which steps of the last configure took the most time\n"
   " d : delete an option\n"
+  " r : asks for a directory and a new location for it, and moves every "
+  "path and file path option below the directory there.\n"
+  " e : edits a list value, like a search path, one element per line. "
+  "Elements can be edited, added and deleted; press e again to keep the "
+  "changes or q to drop them.\n"
+  " u : undoes the last change of an option, deletion or configure\n"
+  " ctrl-r : redoes what was undone\n"
   " t : toggles advanced mode. In normal mode, only the most important "
   "options are shown. In advanced mode, all options are shown. We recommend "
   "using normal mode unless you are an expert.\n"
-  " / : search for a variable name.\n";
+  " v : toggles between the list of options and a tree that groups them by "
+  "the prefixes of their names. Press enter on a group to open or close "
+  "it.\n"
+  " / : search for a variable name.\n"
+  " f : filter the options while typing: only the options whose name, "
+  "value or help string contains the text are shown. Press enter to "
+  "keep the filter, and escape to show all options again.\n"
+  " ? : lists the options that best match the words of a question, like "
+  "\"where is the CUDA architecture set\". Options whose name contains a "
+  "word come first, then those whose value or help string does. Small "
+  "typos are tolerated. Press escape to show all options again.\n";
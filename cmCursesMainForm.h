@@ -5,10 +5,14 @@
 
 #include "cmConfigure.h"
 
+#include "cmCacheDiff.h"
 #include "cmCursesForm.h"
 #include "cmCursesStandardIncludes.h"
+#include "cmState.h"
 #include "cmStateTypes.h"
 
+#include <memory>
+#include <set>
 #include <stddef.h>
 #include <string>
 #include <vector>
@@ -30,7 +34,8 @@ public:
   ~cmCursesMainForm() CM_OVERRIDE;
 
   /**
-   * Set the widgets which represent the cache entries.
+   * Set the widgets which represent the cache entries.  Called when the
+   * cache was read from cmake, which then has this cache.
    */
   void InitializeUI();
 
@@ -45,18 +50,13 @@ public:
    */
   void Render(int left, int top, int width, int height) CM_OVERRIDE;
 
-  /**
-   * Returns true if an entry with the given key is in the
-   * list of current composites.
-   */
-  bool LookForCacheEntry(const std::string& key);
-
   enum
   {
     MIN_WIDTH = 65,
     MIN_HEIGHT = 6,
     IDEAL_WIDTH = 80,
-    MAX_WIDTH = 512
+    MAX_WIDTH = 512,
+    MAX_UNDO_LEVELS = 256
   };
 
   /**
@@ -76,6 +76,12 @@ public:
    */
   void PrintKeys(int process = 0);
 
+  /**
+   * Forget what is on the toolbar, so that all of it is drawn again.
+   * Needed after the screen was cleared or resized.
+   */
+  void InvalidateToolbar();
+
   /**
    * During a CMake run, an error handle should add errors
    * to be displayed afterwards.
@@ -98,33 +104,250 @@ public:
    */
   int LoadCache(const char* dir);
 
+  /**
+   * The cmake session driven by this form.
+   */
+  cmake* GetCMakeInstance() { return this->CMakeInstance; }
+
   /**
    * Progress callback
    */
   static void UpdateProgressOld(const char* msg, float prog, void*);
   static void UpdateProgress(const char* msg, float prog, void*);
 
+  /**
+   * Called on the loop when the cache of a configure step has arrived
+   */
+  static void CacheLoaded(void*);
+
 protected:
+  // Create the composites for the entries of the cache.
+  void CreateEntries();
   // Copy the cache values from the user interface to the actual
   // cache.
   void FillCacheManagerFromUI();
-  // Fix formatting of values to a consistent form.
-  void FixValue(cmStateEnums::CacheEntryType type, const std::string& in,
-                std::string& out) const;
+  // Copy the value of one entry to the cache. Remembers the previous
+  // state for undo if the value changed.
+  void CommitEntry(cmCursesCacheEntryComposite* entry);
+  // Remember the current state of the cache for undo.
+  void PushUndo();
+  // Go back to the state on top of the "from" stack, and push the
+  // current state onto the "to" stack.
+  void RestoreCache(std::vector<cmState::Snapshot>& from,
+                    std::vector<cmState::Snapshot>& to);
+  // Mark the entries that differ from the cache that cmake has as
+  // modified, and those that it has but the state lacks as removed, so
+  // that the next configure step sends them.
+  void MarkServerChanges();
+  // Recompute the rows of Entries that are shown in normal and in
+  // advanced mode.
+  void UpdateVisibleRows();
+  // Rows shown in the current mode, in display order.
+  std::vector<size_t> const& GetVisibleRows() const
+  {
+    if (!this->RankedQuery.empty()) {
+      return this->RankedRows;
+    }
+    if (!this->FilterRows.empty()) {
+      return this->FilterRows.back();
+    }
+    if (this->TreeMode) {
+      return this->TreeRows;
+    }
+    return this->AdvancedMode ? this->AdvancedRows : this->NormalRows;
+  }
+  // The composite of a row: an entry, or the header of a group in the
+  // tree view.  Entries only have one while they are on screen.
+  cmCursesCacheEntryComposite* GetRowEntry(size_t row) const;
+  // The name of the entry or group in a row.
+  const char* GetRowKey(size_t row) const;
+
+  // A group of entries whose keys share a prefix ending with an
+  // underscore, or a single entry, in the tree view.  Like entries,
+  // the header of a group only has widgets while it is on screen.
+  struct TreeNode
+  {
+    size_t Row;         // row of the entry, or of the group header
+    size_t End;         // index of the first node after the subtree
+    std::string Prefix; // empty for entries
+    size_t Count;       // number of entries in the group
+    int Depth;
+    bool Open;
+    cmCursesCacheEntryComposite* Header;
+  };
+  struct EntryTree
+  {
+    std::vector<TreeNode> Nodes; // in display order
+    std::vector<size_t> Groups;  // node of each group, by header row
+    bool Valid = false;
+  };
+  EntryTree& GetCurrentTree()
+  {
+    return this->Trees[this->AdvancedMode ? 1 : 0];
+  }
+  // Build the tree of the entries in the given rows.
+  void BuildTree(EntryTree& tree, std::vector<size_t> rows);
+  void AddTreeNodes(EntryTree& tree, std::vector<size_t> const& rows,
+                    size_t begin, size_t end, size_t offset, int depth);
+  // The node of the group whose header is in the row.
+  TreeNode& GetGroupNode(size_t row);
+  TreeNode const& GetGroupNode(size_t row) const;
+  void CreateGroupHeader(TreeNode& node);
+  static void SetGroupLabel(TreeNode const& node);
+  // Delete the trees, they are built again when needed.
+  void ClearTrees();
+  // Compute the rows of the tree view that are not in closed groups.
+  void UpdateTreeRows();
+  // The group whose header is the current field, if any.
+  TreeNode* GetCurrentGroup();
+  // Open or close the group whose header is the current field.
+  void ToggleCurrentGroup();
   // Re-post the existing fields. Used to toggle between
   // normal and advanced modes. Render() should be called
   // afterwards.
   void RePost();
+  // Draw a line of the toolbar, counted from the status bar, unless
+  // it already shows the text.
+  void DrawToolbarLine(int line, std::string text);
+  // Unpost and free the form, so that its fields can be deleted.
+  void FreeForm();
+  // Index of the current row among the visible rows.
+  size_t GetCurrentIndex() const;
+  // Make the visible row at the index current, showing its page.
+  void ShowRow(size_t index);
+  // Whether the key moves between entries or pages.
+  static bool IsNavigationKey(int key);
+  // Whether the key only shows entries or messages, and so can be
+  // used while the cache is loading.
+  static bool IsViewingKey(int key);
+  // The visible row that a navigation key moves to from the index.
+  size_t MoveIndex(int key, size_t index) const;
+  // Make the entry with the given key current if it is visible.
+  void ShowEntry(std::string const& key);
   // Remove an entry from the interface and the cache.
   void RemoveEntry(const char* value);
 
+  // Whether the key, value or help string of the entry in the row
+  // contains the needle, ignoring case.  The needle is in lower case.
+  bool RowMatches(size_t row, std::string const& needle) const;
+  // Add a character to the filter.
+  void ExtendFilter(char c);
+  // Apply the filter again after the entries or the mode changed.
+  void UpdateFilter();
+  // Handle a key typed while the filter is edited.
+  void HandleFilterKey(int key);
+  // Whether only the entries matching the filter or a query are shown.
+  bool IsFiltered() const
+  {
+    return !this->FilterRows.empty() || !this->RankedQuery.empty();
+  }
+  // Show the entries that match the words of the query, best first.
+  void RankEntries(std::string const& query);
+  // Show all entries again.
+  void ClearFilters();
+
   // Jump to the cache entry whose name matches the string.
   void JumpToCacheEntry(const char* str);
+  // Index the keys of the visible rows for searching.
+  void BuildKeyIndex();
+
+  // Read a line of text in the status bar. Returns false if the
+  // user cancelled with escape.
+  bool PromptString(const char* prompt, std::string& str);
+
+  // Show the cache changes made by the last configure step.
+  void ShowConfigureChanges();
+  // Once the cache of the last configure step has arrived, find what
+  // it changed and create the entries again.  Returns false while it
+  // is still loading, or if it was handled already.
+  bool FinishConfigure();
+
+  // Ask for another build directory and show how its cache
+  // differs from the current one.
+  void CompareWithBuildDirectory();
+
+  // Ask for a directory and a new location for it, and move the
+  // PATH and FILEPATH entries below the directory there.
+  void RelocatePaths();
+
+  // Show where the time of the last configure step went.
+  void ShowProfile();
+
+  // Edit the value of the current entry as a list, one element at a
+  // time.
+  void EditList();
 
-  // Copies of cache entries stored in the user interface
-  std::vector<cmCursesCacheEntryComposite*>* Entries;
+  // An entry of the cache shown in the user interface.  Its widgets
+  // exist only while it is on screen.
+  struct EntryRow
+  {
+    cmState::EntryId Id;
+    const char* Key; // owned by the string pool of the state
+    bool IsNew;
+    cmCursesCacheEntryComposite* Composite;
+  };
+  // Entries shown in the user interface, new ones first
+  std::vector<EntryRow> Entries;
+  // Rows of Entries that have widgets, because they are on screen
+  std::vector<size_t> LiveRows;
+  // Shown when the cache is empty, and when no entry matches the
+  // filter
+  cmCursesCacheEntryComposite* EmptyEntry;
+  cmCursesCacheEntryComposite* NoMatchEntry;
+  static cmCursesCacheEntryComposite* CreatePlaceholder(const char* label);
+  // Indices into Entries of the entries visible in normal and in
+  // advanced mode, kept sorted
+  std::vector<size_t> NormalRows;
+  std::vector<size_t> AdvancedRows;
+  // Trees of the entries visible in normal and advanced mode, the rows
+  // of the tree view that are shown and the nodes they come from
+  EntryTree Trees[2];
+  std::vector<size_t> TreeRows;
+  std::vector<size_t> TreeRowNodes;
+  // Groups of either tree whose headers have widgets
+  std::vector<TreeNode*> LiveGroups;
+  // The keys of the visible rows in display order, in lower case and
+  // each followed by a newline, and the offset of each one.  Built on
+  // the first search after the visible rows change.
+  struct SearchIndex
+  {
+    std::string Keys;
+    std::vector<size_t> Offsets;
+    bool Valid = false;
+  };
+  SearchIndex KeyIndex;
+  // The live filter, and for each of its prefixes the rows that match
+  // it, so that typing a character only searches the rows that
+  // matched before.  While the filter is not empty, its rows are shown
+  // as a list, also in the tree view.
+  std::string FilterString;
+  std::vector<std::vector<size_t>> FilterRows;
+  // Is the filter being typed ?
+  bool FilterMode;
+  // The last query of the ranked search, and the rows that match it,
+  // best first.  Shown as a list instead of the filtered rows while
+  // the query is not empty.
+  std::string RankedQuery;
+  std::vector<size_t> RankedRows;
+  // Prefixes of the groups that are open in the tree view
+  std::set<std::string> OpenGroups;
+  // Keeps the keys of the entries alive while the state is replaced
+  std::shared_ptr<cmStringPool const> EntriesPool;
+  // States of the cache before the last edits and configure steps,
+  // and states that were undone
+  std::vector<cmState::Snapshot> UndoStack;
+  std::vector<cmState::Snapshot> RedoStack;
+  // The cache as cmake last reported it
+  cmState::Snapshot ServerCache;
   // Errors produced during last run of cmake
   std::vector<std::string> Errors;
+  // Cache changes made by the last configure step
+  std::string ConfigureChanges;
+  // Is the cache of the last configure step still loading ?  Until
+  // it arrives, the old entries are shown and cannot be changed, and
+  // the cache before the configure step is kept for the changes.
+  bool LoadingCache;
+  cmCacheDiff::EntryList ConfigureBefore;
   // Command line argumens to be passed to cmake each time
   // it is run
   std::vector<std::string> Args;
@@ -135,6 +358,15 @@ protected:
   // Common help
   static const char* s_ConstHelpMessage;
 
+  enum
+  {
+    NUMBER_OF_TOOLBAR_LINES = 5
+  };
+  // The lines of the toolbar and the page number as they were last
+  // drawn
+  std::vector<std::string> ToolbarLines;
+  std::string PageLine;
+
   // Fields displayed. Includes labels, new entry markers, entries
   FIELD** Fields;
   // Where is source of current project
@@ -144,10 +376,16 @@ protected:
   // Number of entries shown (depends on mode -normal or advanced-)
   size_t NumberOfVisibleEntries;
   bool AdvancedMode;
+  // Are the entries grouped by prefix ?
+  bool TreeMode;
   // Did the iteration converge (no new entries) ?
   bool OkToGenerate;
   // Number of pages displayed
   int NumberOfPages;
+  // Index among the visible rows of the first row on screen, and the
+  // number of rows on a screen
+  size_t FirstRow;
+  size_t PageSize;
 
   int InitialWidth;
   cmake* CMakeInstance;
@@ -21,26 +21,20 @@ cmCursesOptionsWidget::cmCursesOptionsWidget(int width, int height, int left,
 }
 
 bool cmCursesOptionsWidget::HandleInput(int& key, cmCursesMainForm* /*fm*/,
-                                        WINDOW* w)
+                                        WINDOW* /*w*/)
 {
   switch (key) {
     case 10: // 10 == enter
     case KEY_ENTER:
       this->NextOption();
-      touchwin(w);
-      wrefresh(w);
       return true;
     case KEY_LEFT:
     case ctrl('b'):
-      touchwin(w);
-      wrefresh(w);
       this->PreviousOption();
       return true;
     case KEY_RIGHT:
     case ctrl('f'):
       this->NextOption();
-      touchwin(w);
-      wrefresh(w);
       return true;
     default:
       return false;
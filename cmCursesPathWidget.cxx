@@ -3,12 +3,12 @@
 #include "cmCursesPathWidget.h"
 
 #include "cmCursesMainForm.h"
+#include "cmCursesScreen.h"
 #include "cmCursesStringWidget.h"
+#include "cmDirectoryCache.h"
 #include "cmStateTypes.h"
 #include "cmSystemTools.h"
 
-#include <vector>
-
 cmCursesPathWidget::cmCursesPathWidget(int width, int height, int left,
                                        int top)
   : cmCursesStringWidget(width, height, left, top)
@@ -22,11 +22,42 @@ void cmCursesPathWidget::OnType(int& key, cmCursesMainForm* fm, WINDOW* w)
 {
   this->Cycle = false;
   this->CurrentIndex = 0;
-  this->LastGlob = "";
+  this->Candidates.clear();
   this->cmCursesStringWidget::OnType(key, fm, w);
 }
 
-void cmCursesPathWidget::OnTab(cmCursesMainForm* fm, WINDOW* w)
+void cmCursesPathWidget::FindCandidates(std::string const& str,
+                                        cmCursesMainForm* fm)
+{
+  this->Candidates.clear();
+  // Split like cmSystemTools::SimpleGlob() does with str + "*".
+  std::string dir = cmSystemTools::GetFilenamePath(str + "*");
+  std::string const prefix = cmSystemTools::GetFilenameName(str);
+  if (dir.empty()) {
+    dir = "/";
+  }
+  std::shared_ptr<cmDirectoryCache::Listing const> listing =
+    cmDirectoryCache::Find(dir);
+  if (!listing) {
+    fm->UpdateStatusBar("Reading directory...");
+    cmCursesScreen::Update();
+    listing = cmDirectoryCache::Wait(dir);
+    fm->UpdateStatusBar();
+  }
+  if (dir.back() != '/') {
+    dir += '/';
+  }
+  auto const range = cmDirectoryCache::FindPrefix(*listing, prefix);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->IsDirectory) {
+      this->Candidates.push_back(dir + it->Name + "/");
+    } else if (this->Type != cmStateEnums::PATH) {
+      this->Candidates.push_back(dir + it->Name);
+    }
+  }
+}
+
+void cmCursesPathWidget::OnTab(cmCursesMainForm* fm, WINDOW* /*w*/)
 {
   if (!this->GetString()) {
     return;
@@ -39,43 +70,37 @@ void cmCursesPathWidget::OnTab(cmCursesMainForm* fm, WINDOW* w)
   if (this->LastString != cstr) {
     this->Cycle = false;
     this->CurrentIndex = 0;
-    this->LastGlob = "";
-  }
-  std::string glob;
-  if (this->Cycle) {
-    glob = this->LastGlob;
-  } else {
-    glob = cstr + "*";
   }
-  std::vector<std::string> dirs;
-
-  cmSystemTools::SimpleGlob(glob, dirs,
-                            (this->Type == cmStateEnums::PATH ? -1 : 0));
-  if (this->CurrentIndex < dirs.size()) {
-    cstr = dirs[this->CurrentIndex];
+  // Cycling goes through the candidates found on the first Tab.
+  if (!this->Cycle) {
+    this->FindCandidates(cstr, fm);
   }
-  if (cstr[cstr.size() - 1] == '*') {
-    cstr = cstr.substr(0, cstr.size() - 1);
+  if (this->CurrentIndex < this->Candidates.size()) {
+    cstr = this->Candidates[this->CurrentIndex];
   }
-
-  if (cmSystemTools::FileIsDirectory(cstr)) {
-    cstr += "/";
+  // A unique directory is likely completed further next.
+  if (this->Candidates.size() == 1 && cstr.back() == '/') {
+    cmDirectoryCache::Prefetch(cstr.substr(0, cstr.size() - 1));
   }
 
   this->SetString(cstr);
-  touchwin(w);
-  wrefresh(w);
   form_driver(form, REQ_END_FIELD);
-  this->LastGlob = glob;
   this->LastString = cstr;
   this->Cycle = true;
   this->CurrentIndex++;
-  if (this->CurrentIndex >= dirs.size()) {
+  if (this->CurrentIndex >= this->Candidates.size()) {
     this->CurrentIndex = 0;
   }
 }
 
 void cmCursesPathWidget::OnReturn(cmCursesMainForm* fm, WINDOW* w)
 {
+  // Entering edit: read the directory of the value meanwhile.
+  if (!this->InEdit && this->GetString()) {
+    std::string cstr = this->GetString();
+    cstr = cstr.substr(0, cstr.find_last_not_of(" \t\n\r") + 1);
+    std::string const dir = cmSystemTools::GetFilenamePath(cstr + "*");
+    cmDirectoryCache::Prefetch(dir.empty() ? "/" : dir);
+  }
   this->cmCursesStringWidget::OnReturn(fm, w);
 }
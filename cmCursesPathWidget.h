@@ -9,6 +9,7 @@
 #include "cmCursesStringWidget.h"
 
 #include <string>
+#include <vector>
 
 class cmCursesMainForm;
 
@@ -28,8 +29,14 @@ public:
   void OnType(int& key, cmCursesMainForm* fm, WINDOW* w) CM_OVERRIDE;
 
 protected:
+  // Find the completions of the string, from the cached listing of its
+  // directory.
+  void FindCandidates(std::string const& str, cmCursesMainForm* fm);
+
   std::string LastString;
-  std::string LastGlob;
+  // The completions that Tab cycles through, with a slash after
+  // directories
+  std::vector<std::string> Candidates;
   bool Cycle;
   std::string::size_type CurrentIndex;
 };
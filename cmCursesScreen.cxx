@@ -0,0 +1,203 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmCursesScreen.h"
+
+#include "cmCursesForm.h"
+#include "cmTrace.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <uv.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+namespace {
+
+// Wait this long after the last resize signal before laying out again.
+const std::uint64_t ResizeDelayMs = 40;
+
+uv_signal_t ResizeSignal;
+uv_timer_t ResizeTimer;
+uv_poll_t Input;
+bool Started = false;
+bool Polling = false;
+bool InputReady = false;
+bool ResizePending = false;
+bool WakePending = false;
+
+// The loop may be running for a server request here, so only note
+// what happened; GetKey() acts on it.
+void OnResizeTimer(uv_timer_t* /*handle*/)
+{
+  ResizePending = true;
+}
+
+void OnResizeSignal(uv_signal_t* /*handle*/, int /*signum*/)
+{
+  // Restart the delay, so a burst of signals ends in one layout.
+  uv_timer_start(&ResizeTimer, OnResizeTimer, ResizeDelayMs, 0);
+}
+
+void OnInput(uv_poll_t* /*handle*/, int /*status*/, int /*events*/)
+{
+  InputReady = true;
+}
+}
+
+std::uint64_t cmCursesScreen::Updates = 0;
+std::uint64_t cmCursesScreen::BytesWritten = 0;
+
+void cmCursesScreen::Update(WINDOW* w)
+{
+  wnoutrefresh(w);
+  cmCursesScreen::Send();
+}
+
+void cmCursesScreen::UpdatePad(WINDOW* pad, int top, int left, int bottom,
+                               int right)
+{
+  // The pad goes last, so that lines of stdscr below it do not cover
+  // it.
+  wnoutrefresh(stdscr);
+  pnoutrefresh(pad, 0, 0, top, left, bottom, right);
+  cmCursesScreen::Send();
+}
+
+void cmCursesScreen::Send()
+{
+  std::uint64_t const begin = cmTrace::IsEnabled() ? uv_hrtime() : 0;
+  std::uint64_t const before = cmCursesScreen::ReadBytesWritten();
+  doupdate();
+  std::uint64_t const bytes = cmCursesScreen::ReadBytesWritten() - before;
+  ++cmCursesScreen::Updates;
+  cmCursesScreen::BytesWritten += bytes;
+  if (cmTrace::IsEnabled()) {
+    cmTrace::AddSpan("Update", begin, uv_hrtime(), "bytes",
+                     static_cast<int>(bytes));
+  }
+}
+
+void cmCursesScreen::Start()
+{
+  uv_loop_t* loop = uv_default_loop();
+  uv_signal_init(loop, &ResizeSignal);
+  uv_signal_start(&ResizeSignal, OnResizeSignal, SIGWINCH);
+  uv_timer_init(loop, &ResizeTimer);
+  // Neither keeps the loop running while the server is waited for.
+  uv_unref(reinterpret_cast<uv_handle_t*>(&ResizeSignal));
+  uv_unref(reinterpret_cast<uv_handle_t*>(&ResizeTimer));
+  // Some systems cannot poll a terminal; keys are then read directly
+  // and resizes are handled when the next key arrives.
+  Polling = uv_poll_init(loop, &Input, STDIN_FILENO) == 0;
+  Started = true;
+}
+
+void cmCursesScreen::Stop()
+{
+  if (!Started) {
+    return;
+  }
+  uv_close(reinterpret_cast<uv_handle_t*>(&ResizeSignal), CM_NULLPTR);
+  uv_close(reinterpret_cast<uv_handle_t*>(&ResizeTimer), CM_NULLPTR);
+  if (Polling) {
+    uv_close(reinterpret_cast<uv_handle_t*>(&Input), CM_NULLPTR);
+  }
+  uv_run(uv_default_loop(), UV_RUN_NOWAIT);
+  Started = false;
+  Polling = false;
+}
+
+int cmCursesScreen::GetKey()
+{
+  for (;;) {
+    if (WakePending) {
+      WakePending = false;
+      return KEY_REFRESH;
+    }
+    if (ResizePending) {
+      ResizePending = false;
+      cmCursesScreen::Resize();
+      return KEY_RESIZE;
+    }
+    if (!Polling) {
+      return getch();
+    }
+    // Keys that curses has already read come first.
+    nodelay(stdscr, true);
+    int const key = getch();
+    nodelay(stdscr, false);
+    if (key != ERR) {
+      return key;
+    }
+    InputReady = false;
+    uv_poll_start(&Input, UV_READABLE, OnInput);
+    while (!InputReady && !ResizePending && !WakePending) {
+      uv_run(uv_default_loop(), UV_RUN_ONCE);
+    }
+    uv_poll_stop(&Input);
+  }
+}
+
+void cmCursesScreen::Wake()
+{
+  WakePending = true;
+}
+
+bool cmCursesScreen::IsPolling()
+{
+  return Polling;
+}
+
+void cmCursesScreen::Resize()
+{
+  cmTraceScope scope("Resize");
+#if defined(TIOCGWINSZ)
+  struct winsize size;
+  if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 &&
+      size.ws_col > 0) {
+    resizeterm(size.ws_row, size.ws_col);
+  }
+#else
+  endwin();
+  refresh();
+#endif
+  if (cmCursesForm::CurrentForm) {
+    int x, y;
+    getmaxyx(stdscr, y, x);
+    curses_clear();
+    cmCursesForm::CurrentForm->Render(1, 1, x, y);
+    cmCursesForm::CurrentForm->UpdateStatusBar();
+    cmCursesScreen::Update();
+  }
+}
+
+std::uint64_t cmCursesScreen::ReadBytesWritten()
+{
+#if defined(__linux__)
+  // The file stays open, each read returns the current counters of
+  // the thread that opened it, which is the one that draws.
+  static int const fd = open("/proc/thread-self/io", O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  char buf[512];
+  ssize_t const n = pread(fd, buf, sizeof(buf) - 1, 0);
+  if (n <= 0) {
+    return 0;
+  }
+  buf[n] = '\0';
+  // Bytes passed to write(), whether or not they reached a disk.
+  const char* wchar = strstr(buf, "wchar:");
+  if (!wchar) {
+    return 0;
+  }
+  return strtoull(wchar + 6, CM_NULLPTR, 10);
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,86 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmCursesScreen_h
+#define cmCursesScreen_h
+
+#include "cmConfigure.h"
+
+#include "cmCursesStandardIncludes.h"
+
+#include <cstdint>
+
+/** \class cmCursesScreen
+ * \brief Sends the changes of the screen to the terminal.
+ *
+ * Update() copies the changed lines of a window to the virtual screen
+ * with wnoutrefresh() and sends the difference to the terminal with a
+ * single doupdate().  Callers draw only what changed and must not
+ * touchwin() first, or curses compares every line again.
+ *
+ * The bytes written to the terminal are counted where the system
+ * reports the output of each thread, which is /proc/thread-self/io on
+ * Linux; elsewhere only the updates are counted.  The count is the
+ * bytes that the user interface thread passed to write() during
+ * updates.  That is what curses sent, approximately: the log and other
+ * threads are not counted, but nothing tells curses' writes from others
+ * on the same thread.
+ *
+ * Between Start() and Stop(), GetKey() waits for keys on the libuv
+ * loop, so that the loop also sees SIGWINCH.  A burst of resize
+ * signals, as from dragging a window border, is merged into a single
+ * relayout of the current form, done by GetKey() before it returns
+ * the next key.  Callbacks on the loop that change what is shown call
+ * Wake(), and GetKey() returns KEY_REFRESH so that the caller can draw
+ * again.
+ */
+class cmCursesScreen
+{
+public:
+  static void Update(WINDOW* w = stdscr);
+
+  // Update stdscr, then show the top left corner of the pad in the
+  // rectangle of the screen from top, left to bottom, right.
+  static void UpdatePad(WINDOW* pad, int top, int left, int bottom,
+                        int right);
+
+  // Watch for terminal resizes and input on the default libuv loop.
+  static void Start();
+  static void Stop();
+
+  // Read a key like getch().  If the terminal was resized, lay out the
+  // current form again and return KEY_RESIZE.  After Wake(), return
+  // KEY_REFRESH.
+  static int GetKey();
+
+  // Make GetKey() return KEY_REFRESH.
+  static void Wake();
+
+  // Whether GetKey() runs the loop while it waits for a key.  If not,
+  // nothing happens on the loop until the next key.
+  static bool IsPolling();
+
+  static std::uint64_t GetNumberOfUpdates()
+  {
+    return cmCursesScreen::Updates;
+  }
+  static std::uint64_t GetBytesWritten()
+  {
+    return cmCursesScreen::BytesWritten;
+  }
+
+private:
+  // Send the virtual screen to the terminal and count the update.
+  static void Send();
+
+  // Adopt the new size of the terminal and render the current form.
+  static void Resize();
+
+  // Total of the bytes written by the calling thread, or 0 if
+  // unknown.
+  static std::uint64_t ReadBytesWritten();
+
+  static std::uint64_t Updates;
+  static std::uint64_t BytesWritten;
+};
+
+#endif // cmCursesScreen_h
@@ -4,11 +4,12 @@
 
 #include "cmCursesForm.h"
 #include "cmCursesMainForm.h"
+#include "cmCursesScreen.h"
 #include "cmCursesStandardIncludes.h"
 #include "cmCursesWidget.h"
+#include "cmLogger.h"
 #include "cmStateTypes.h"
 
-#include <stdio.h>
 #include <string.h>
 
 inline int ctrl(int z)
@@ -37,7 +38,7 @@ void cmCursesStringWidget::OnReturn(cmCursesMainForm* fm, WINDOW* /*unused*/)
 {
   FORM* form = fm->GetForm();
   if (this->InEdit) {
-    cmCursesForm::LogMessage("String widget leaving edit.");
+    cmLogger::Log(cmLogger::LevelDebug, "String widget leaving edit.");
     this->InEdit = false;
     fm->PrintKeys();
     delete[] this->OriginalString;
@@ -46,7 +47,7 @@ void cmCursesStringWidget::OnReturn(cmCursesMainForm* fm, WINDOW* /*unused*/)
     form_driver(form, REQ_PREV_FIELD);
     this->Done = true;
   } else {
-    cmCursesForm::LogMessage("String widget entering edit.");
+    cmLogger::Log(cmLogger::LevelDebug, "String widget entering edit.");
     this->InEdit = true;
     fm->PrintKeys();
     char* buf = field_buffer(this->Field, 0);
@@ -77,12 +78,10 @@ bool cmCursesStringWidget::HandleInput(int& key, cmCursesMainForm* fm,
   this->OriginalString = CM_NULLPTR;
   this->Done = false;
 
-  char debugMessage[128];
-
   // <Enter> is used to change edit mode (like <Esc> in vi).
   while (!this->Done) {
-    sprintf(debugMessage, "String widget handling input, key: %d", key);
-    cmCursesForm::LogMessage(debugMessage);
+    cmLogger::Log(cmLogger::LevelTrace,
+                  "String widget handling input, key: %d", key);
 
     fm->PrintKeys();
 
@@ -93,7 +92,7 @@ bool cmCursesStringWidget::HandleInput(int& key, cmCursesMainForm* fm,
       if (key == 'q') {
         return false;
       }
-      key = getch();
+      key = cmCursesScreen::GetKey();
       continue;
     }
 
@@ -125,8 +124,6 @@ bool cmCursesStringWidget::HandleInput(int& key, cmCursesMainForm* fm,
         fm->PrintKeys();
         this->SetString(this->OriginalString);
         delete[] this->OriginalString;
-        touchwin(w);
-        wrefresh(w);
         return true;
       }
     } else if (key == 9) {
@@ -153,10 +150,8 @@ bool cmCursesStringWidget::HandleInput(int& key, cmCursesMainForm* fm,
       this->OnType(key, fm, w);
     }
     if (!this->Done) {
-      touchwin(w);
-      wrefresh(w);
-
-      key = getch();
+      cmCursesScreen::Update(w);
+      key = cmCursesScreen::GetKey();
     }
   }
   return true;
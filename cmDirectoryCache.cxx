@@ -0,0 +1,192 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmDirectoryCache.h"
+
+#include "cmTrace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <dirent.h>
+#include <map>
+#include <sys/stat.h>
+#include <uv.h>
+
+namespace {
+
+struct Stamp
+{
+  std::int64_t Seconds = 0;
+  long Nanoseconds = 0;
+
+  bool operator==(Stamp const& other) const
+  {
+    return this->Seconds == other.Seconds &&
+      this->Nanoseconds == other.Nanoseconds;
+  }
+};
+
+bool read_stamp(std::string const& path, Stamp& stamp)
+{
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  stamp.Seconds = static_cast<std::int64_t>(st.st_mtime);
+#if defined(__linux__)
+  stamp.Nanoseconds = st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+  stamp.Nanoseconds = st.st_mtimespec.tv_nsec;
+#endif
+  return true;
+}
+
+struct CachedDirectory
+{
+  std::shared_ptr<cmDirectoryCache::Listing const> Listing;
+  Stamp Time;
+  bool Valid = false; // the directory existed when it was read
+  bool Loading = false;
+};
+
+// Only used on the loop thread.
+std::map<std::string, CachedDirectory> Directories;
+
+struct DirectoryRead
+{
+  uv_work_t Request;
+  std::string Path;
+
+  // Written by the worker, read by the loop thread once it is done.
+  std::shared_ptr<cmDirectoryCache::Listing> Listing;
+  Stamp Time;
+  bool Valid = false;
+  std::uint64_t Start = 0;
+  std::uint64_t End = 0;
+};
+
+// Runs on a worker thread; must not touch anything but the read.
+void read_directory(uv_work_t* req)
+{
+  DirectoryRead& read = *static_cast<DirectoryRead*>(req->data);
+  read.Start = uv_hrtime();
+  read.Listing = std::make_shared<cmDirectoryCache::Listing>();
+  // The time is taken first, so that a change made while reading
+  // causes another read.
+  read.Valid = read_stamp(read.Path, read.Time);
+  DIR* dir = read.Valid ? opendir(read.Path.c_str()) : nullptr;
+  if (dir) {
+    std::string prefix = read.Path;
+    if (prefix.empty() || prefix.back() != '/') {
+      prefix += '/';
+    }
+    while (struct dirent* d = readdir(dir)) {
+      std::string name = d->d_name;
+      if (name == "." || name == "..") {
+        continue;
+      }
+      bool isDirectory = false;
+#if defined(DT_DIR)
+      if (d->d_type != DT_LNK && d->d_type != DT_UNKNOWN) {
+        isDirectory = d->d_type == DT_DIR;
+      } else
+#endif
+      {
+        // Follow links, like cmSystemTools::FileIsDirectory().
+        struct stat st;
+        isDirectory =
+          stat((prefix + name).c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+      }
+      cmDirectoryCache::Entry const entry = { std::move(name), isDirectory };
+      read.Listing->push_back(entry);
+    }
+    closedir(dir);
+  }
+  std::sort(read.Listing->begin(), read.Listing->end(),
+            [](cmDirectoryCache::Entry const& l,
+               cmDirectoryCache::Entry const& r) { return l.Name < r.Name; });
+  read.End = uv_hrtime();
+}
+
+void read_done(uv_work_t* req, int /*status*/)
+{
+  std::unique_ptr<DirectoryRead> read(static_cast<DirectoryRead*>(req->data));
+  if (cmTrace::IsEnabled()) {
+    cmTrace::AddSpan("ReadDirectory", read->Start, read->End, "entries",
+                     static_cast<int>(read->Listing->size()));
+  }
+  CachedDirectory& cached = Directories[read->Path];
+  cached.Listing = std::move(read->Listing);
+  cached.Time = read->Time;
+  cached.Valid = read->Valid;
+  cached.Loading = false;
+}
+
+void start_read(std::string const& path, CachedDirectory& cached)
+{
+  cached.Loading = true;
+  DirectoryRead* read = new DirectoryRead;
+  read->Request.data = read;
+  read->Path = path;
+  uv_queue_work(uv_default_loop(), &read->Request, read_directory,
+                read_done);
+}
+
+// Whether the cached listing is still that of the directory.
+bool is_current(std::string const& path, CachedDirectory const& cached)
+{
+  if (!cached.Listing || !cached.Valid) {
+    return false;
+  }
+  Stamp now;
+  return read_stamp(path, now) && now == cached.Time;
+}
+}
+
+void cmDirectoryCache::Prefetch(std::string const& dir)
+{
+  cmDirectoryCache::Find(dir);
+}
+
+std::shared_ptr<cmDirectoryCache::Listing const> cmDirectoryCache::Find(
+  std::string const& dir)
+{
+  CachedDirectory& cached = Directories[dir];
+  if (cached.Loading) {
+    return nullptr;
+  }
+  if (is_current(dir, cached)) {
+    return cached.Listing;
+  }
+  start_read(dir, cached);
+  return nullptr;
+}
+
+std::shared_ptr<cmDirectoryCache::Listing const> cmDirectoryCache::Wait(
+  std::string const& dir)
+{
+  std::shared_ptr<Listing const> listing = cmDirectoryCache::Find(dir);
+  if (listing) {
+    return listing;
+  }
+  // The pending read keeps the loop alive until it is done.
+  CachedDirectory const& cached = Directories[dir];
+  while (cached.Loading) {
+    uv_run(uv_default_loop(), UV_RUN_ONCE);
+  }
+  return cached.Listing;
+}
+
+std::pair<cmDirectoryCache::Listing::const_iterator,
+          cmDirectoryCache::Listing::const_iterator>
+cmDirectoryCache::FindPrefix(Listing const& listing, std::string const& prefix)
+{
+  auto const begin = std::lower_bound(
+    listing.begin(), listing.end(), prefix,
+    [](Entry const& entry, std::string const& p) { return entry.Name < p; });
+  auto end = begin;
+  while (end != listing.end() &&
+         end->Name.compare(0, prefix.size(), prefix) == 0) {
+    ++end;
+  }
+  return std::make_pair(begin, end);
+}
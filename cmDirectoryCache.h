@@ -0,0 +1,52 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmDirectoryCache_h
+#define cmDirectoryCache_h
+
+#include "cmConfigure.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** \class cmDirectoryCache
+ * \brief Listings of directories for path completion.
+ *
+ * Directories are read on the libuv thread pool.  Whether an entry is a
+ * directory comes from the type that readdir() reports; only symbolic
+ * links and entries of unknown type are stat'ed.  Entries are sorted by
+ * name once, so the entries with a given prefix are a range.
+ *
+ * A listing is kept with the modification time the directory had when
+ * it was read, and read again once that time changes.  Checking costs
+ * one stat of the directory.
+ */
+class cmDirectoryCache
+{
+public:
+  struct Entry
+  {
+    std::string Name;
+    bool IsDirectory;
+  };
+  typedef std::vector<Entry> Listing;
+
+  // Start reading the directory unless it is cached and unchanged, or
+  // being read.
+  static void Prefetch(std::string const& dir);
+
+  // The listing of the directory if it is cached and unchanged.
+  // Otherwise start reading it and return null.
+  static std::shared_ptr<Listing const> Find(std::string const& dir);
+
+  // The listing of the directory, running the default loop until it
+  // has been read.  Empty if the directory cannot be read.
+  static std::shared_ptr<Listing const> Wait(std::string const& dir);
+
+  // The entries whose names start with the prefix.
+  static std::pair<Listing::const_iterator, Listing::const_iterator>
+  FindPrefix(Listing const& listing, std::string const& prefix);
+};
+
+#endif
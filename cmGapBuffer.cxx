@@ -0,0 +1,97 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmGapBuffer.h"
+
+#include <algorithm>
+
+namespace {
+// Room left for typing when the buffer is filled or grows.
+const std::size_t MinimumGap = 64;
+}
+
+cmGapBuffer::cmGapBuffer()
+  : GapBegin(0)
+  , GapEnd(0)
+{
+}
+
+void cmGapBuffer::Assign(const char* text, std::size_t length)
+{
+  this->Buffer.assign(text, text + length);
+  this->GapBegin = length;
+  this->Buffer.resize(length + MinimumGap);
+  this->GapEnd = this->Buffer.size();
+}
+
+void cmGapBuffer::MoveCursor(std::size_t pos)
+{
+  pos = std::min(pos, this->GetSize());
+  char* const data = this->Buffer.data();
+  if (pos < this->GapBegin) {
+    // The characters between pos and the cursor go after the gap.
+    std::size_t const count = this->GapBegin - pos;
+    std::copy_backward(data + pos, data + this->GapBegin,
+                       data + this->GapEnd);
+    this->GapBegin -= count;
+    this->GapEnd -= count;
+  } else if (pos > this->GapBegin) {
+    std::size_t const count = pos - this->GapBegin;
+    std::copy(data + this->GapEnd, data + this->GapEnd + count,
+              data + this->GapBegin);
+    this->GapBegin += count;
+    this->GapEnd += count;
+  }
+}
+
+void cmGapBuffer::Insert(char c)
+{
+  if (this->GapBegin == this->GapEnd) {
+    // Double the buffer, the text after the gap moves to the new end.
+    std::size_t const after = this->Buffer.size() - this->GapEnd;
+    std::size_t const size = 2 * this->Buffer.size() + MinimumGap;
+    this->Buffer.resize(size);
+    char* const data = this->Buffer.data();
+    std::copy_backward(data + this->GapEnd, data + this->GapEnd + after,
+                       data + size);
+    this->GapEnd = size - after;
+  }
+  this->Buffer[this->GapBegin++] = c;
+}
+
+bool cmGapBuffer::DeleteBackward()
+{
+  if (this->GapBegin == 0) {
+    return false;
+  }
+  --this->GapBegin;
+  return true;
+}
+
+bool cmGapBuffer::DeleteForward()
+{
+  if (this->GapEnd == this->Buffer.size()) {
+    return false;
+  }
+  ++this->GapEnd;
+  return true;
+}
+
+std::string cmGapBuffer::GetText(std::size_t pos, std::size_t length) const
+{
+  std::size_t const size = this->GetSize();
+  pos = std::min(pos, size);
+  std::size_t const end = pos + std::min(length, size - pos);
+  std::string text;
+  text.reserve(end - pos);
+  const char* const data = this->Buffer.data();
+  if (pos < this->GapBegin) {
+    text.append(data + pos, std::min(end, this->GapBegin) - pos);
+  }
+  if (end > this->GapBegin) {
+    std::size_t const from = std::max(pos, this->GapBegin);
+    std::size_t const gap = this->GapEnd - this->GapBegin;
+    text.append(data + from + gap, end - from);
+  }
+  return text;
+}
@@ -0,0 +1,51 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmGapBuffer_h
+#define cmGapBuffer_h
+
+#include "cmConfigure.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** \class cmGapBuffer
+ * \brief Text with a cursor, cheap to edit at the cursor.
+ *
+ * The characters before the cursor are at the start of the buffer and
+ * those after it at the end, with the unused space in between.  Typing
+ * and deleting at the cursor only move the edges of the gap; moving the
+ * cursor moves the characters between the old and new position.
+ */
+class cmGapBuffer
+{
+public:
+  cmGapBuffer();
+
+  // Replace the text and put the cursor at its end.
+  void Assign(const char* text, std::size_t length);
+
+  std::size_t GetSize() const
+  {
+    return this->Buffer.size() - (this->GapEnd - this->GapBegin);
+  }
+  std::size_t GetCursor() const { return this->GapBegin; }
+  void MoveCursor(std::size_t pos);
+
+  void Insert(char c);
+  // Delete the character before or after the cursor.  Return false if
+  // there is none.
+  bool DeleteBackward();
+  bool DeleteForward();
+
+  // At most length characters of the text from pos.
+  std::string GetText(std::size_t pos, std::size_t length) const;
+  std::string GetText() const { return this->GetText(0, this->GetSize()); }
+
+private:
+  std::vector<char> Buffer;
+  std::size_t GapBegin;
+  std::size_t GapEnd;
+};
+
+#endif
@@ -0,0 +1,196 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmLogger.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include <uv.h>
+
+#include "cmSystemTools.h"
+#include "cmsys/FStream.hxx"
+
+namespace {
+
+const char* const level_names[]{"TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+
+struct Record
+{
+  std::atomic<std::size_t> Sequence;
+  std::uint64_t Time;
+  cmLogger::Level Level;
+  char Text[240];
+};
+
+// Bounded multi-producer, single-consumer ring.  A slot whose sequence
+// equals the enqueue position is free; one that is a position ahead
+// holds a record for the consumer.
+class RecordRing
+{
+public:
+  enum
+  {
+    Capacity = 4096
+  };
+
+  RecordRing()
+  {
+    for (std::size_t i = 0; i < Capacity; ++i) {
+      this->Records[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  Record* BeginPush()
+  {
+    std::size_t pos = this->PushPos.load(std::memory_order_relaxed);
+    for (;;) {
+      Record* record = &this->Records[pos % Capacity];
+      std::size_t const seq = record->Sequence.load(std::memory_order_acquire);
+      if (seq == pos) {
+        if (this->PushPos.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+          return record;
+        }
+      } else if (seq < pos) {
+        return nullptr; // full
+      } else {
+        pos = this->PushPos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void EndPush(Record* record)
+  {
+    std::size_t const seq = record->Sequence.load(std::memory_order_relaxed);
+    record->Sequence.store(seq + 1, std::memory_order_release);
+  }
+
+  Record* BeginPop()
+  {
+    Record* record = &this->Records[this->PopPos % Capacity];
+    std::size_t const seq = record->Sequence.load(std::memory_order_acquire);
+    return seq == this->PopPos + 1 ? record : nullptr;
+  }
+
+  void EndPop(Record* record)
+  {
+    record->Sequence.store(
+      this->PopPos + Capacity, std::memory_order_release);
+    ++this->PopPos;
+  }
+
+private:
+  Record Records[Capacity];
+  std::atomic<std::size_t> PushPos{ 0 };
+  std::size_t PopPos = 0;
+};
+
+RecordRing* s_Ring = nullptr;
+std::thread s_Writer;
+std::atomic<bool> s_Running{ false };
+std::atomic<std::size_t> s_Dropped{ 0 };
+std::uint64_t s_StartTime = 0;
+
+bool drain(std::ostream& os)
+{
+  bool wrote = false;
+  char prefix[32];
+  while (Record* record = s_Ring->BeginPop()) {
+    sprintf(
+      prefix, "%12.6f %-5s ",
+      static_cast<double>(record->Time - s_StartTime) / 1e9,
+      level_names[record->Level]);
+    os << prefix << record->Text << '\n';
+    s_Ring->EndPop(record);
+    wrote = true;
+  }
+  return wrote;
+}
+
+void write_records(cmsys::ofstream* fout)
+{
+  while (s_Running.load(std::memory_order_acquire)) {
+    if (!drain(*fout)) {
+      // Flush only when idle, so bursts are written in large blocks.
+      fout->flush();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  drain(*fout);
+  std::size_t const dropped = s_Dropped.load();
+  if (dropped != 0) {
+    *fout << dropped << " records were dropped because the log ring was "
+          << "full.\n";
+  }
+  delete fout;
+}
+
+} // namespace
+
+std::atomic<int> cmLogger::Threshold{ cmLogger::LevelOff };
+
+bool cmLogger::Start(std::string const& file, Level threshold)
+{
+  if (s_Running.load()) {
+    return true;
+  }
+  cmsys::ofstream* fout = new cmsys::ofstream(file.c_str());
+  if (!*fout) {
+    delete fout;
+    return false;
+  }
+  if (!s_Ring) {
+    s_Ring = new RecordRing;
+  }
+  s_StartTime = uv_hrtime();
+  s_Running.store(true);
+  s_Writer = std::thread(write_records, fout);
+  cmLogger::Threshold.store(threshold);
+  return true;
+}
+
+void cmLogger::Stop()
+{
+  if (!s_Running.load()) {
+    return;
+  }
+  cmLogger::Threshold.store(LevelOff);
+  s_Running.store(false, std::memory_order_release);
+  s_Writer.join();
+}
+
+bool cmLogger::ParseLevel(std::string const& name, Level& level)
+{
+  std::string const upper = cmSystemTools::UpperCase(name);
+  for (int i = LevelTrace; i != LevelOff; ++i) {
+    if (upper == level_names[i]) {
+      level = static_cast<Level>(i);
+      return true;
+    }
+  }
+  if (upper == "WARNING") {
+    level = LevelWarning;
+    return true;
+  }
+  return false;
+}
+
+void cmLogger::Write(Level level, const char* format, ...)
+{
+  Record* record = s_Ring ? s_Ring->BeginPush() : nullptr;
+  if (!record) {
+    s_Dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  record->Time = uv_hrtime();
+  record->Level = level;
+  va_list args;
+  va_start(args, format);
+  vsnprintf(record->Text, sizeof(record->Text), format, args);
+  va_end(args);
+  s_Ring->EndPush(record);
+}
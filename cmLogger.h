@@ -0,0 +1,60 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmLogger_h
+#define cmLogger_h
+
+#include <atomic>
+#include <string>
+
+/** \class cmLogger
+ * \brief Leveled debug log written by a background thread.
+ *
+ * Log() compares the level against the threshold before anything is
+ * formatted.  Enabled records are formatted straight into a slot of a
+ * bounded lock-free ring; a writer thread drains the ring into the log
+ * file, so the calling thread never waits for the disk.  When the ring
+ * is full, records are dropped and counted instead of blocking.
+ */
+class cmLogger
+{
+public:
+  enum Level
+  {
+    LevelTrace,
+    LevelDebug,
+    LevelInfo,
+    LevelWarning,
+    LevelError,
+    LevelOff
+  };
+
+  // Start logging records of at least the given level to file.
+  static bool Start(std::string const& file, Level threshold);
+
+  // Write out the remaining records and stop the writer thread.
+  static void Stop();
+
+  // Set the level named by the string, ignoring case.  Returns false
+  // if there is no such level.
+  static bool ParseLevel(std::string const& name, Level& level);
+
+  static bool IsEnabled(Level level)
+  {
+    return level >= cmLogger::Threshold.load(std::memory_order_relaxed);
+  }
+
+  template <typename... Args>
+  static void Log(Level level, const char* format, Args... args)
+  {
+    if (cmLogger::IsEnabled(level)) {
+      cmLogger::Write(level, format, args...);
+    }
+  }
+
+private:
+  static void Write(Level level, const char* format, ...);
+
+  static std::atomic<int> Threshold;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmPathTrie.h"
+
+cmPathTrie::NodeId const cmPathTrie::Root = 0;
+cmPathTrie::NodeId const cmPathTrie::InvalidNode = static_cast<NodeId>(-1);
+
+cmPathTrie::cmPathTrie()
+{
+  this->Reset();
+}
+
+void cmPathTrie::Reset()
+{
+  this->Components.Reset();
+  this->Nodes.clear();
+  Node const root = { InvalidNode, cmStringPool::Empty, 0 };
+  this->Nodes.push_back(root);
+  this->Rehash(64);
+}
+
+std::uint32_t cmPathTrie::Hash(NodeId parent, cmStringPool::Handle component)
+{
+  std::uint32_t hash = parent * 2654435761u;
+  hash ^= component + 0x9e3779b9u + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+void cmPathTrie::Rehash(std::size_t size)
+{
+  this->Index.assign(size, InvalidNode);
+  std::size_t const mask = size - 1;
+  // The root has no parent and is not in the index.
+  for (NodeId id = 1; id < this->Nodes.size(); ++id) {
+    Node const& node = this->Nodes[id];
+    std::size_t slot = Hash(node.Parent, node.Component) & mask;
+    while (this->Index[slot] != InvalidNode) {
+      slot = (slot + 1) & mask;
+    }
+    this->Index[slot] = id;
+  }
+}
+
+std::size_t cmPathTrie::FindSlot(NodeId parent,
+                                 cmStringPool::Handle component) const
+{
+  std::size_t const mask = this->Index.size() - 1;
+  for (std::size_t slot = Hash(parent, component) & mask;;
+       slot = (slot + 1) & mask) {
+    NodeId const id = this->Index[slot];
+    if (id == InvalidNode) {
+      return slot;
+    }
+    Node const& node = this->Nodes[id];
+    if (node.Parent == parent && node.Component == component) {
+      return slot;
+    }
+  }
+}
+
+template <typename F>
+cmPathTrie::NodeId cmPathTrie::Walk(std::string const& path, F child) const
+{
+  NodeId node = Root;
+  std::string::size_type begin = 0;
+  if (!path.empty() && path[0] == '/') {
+    node = child(node, "", 0);
+    begin = 1;
+  }
+  while (node != InvalidNode && begin < path.size()) {
+    std::string::size_type end = path.find('/', begin);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    if (end > begin) {
+      node = child(node, path.data() + begin, end - begin);
+    }
+    begin = end + 1;
+  }
+  return node;
+}
+
+cmPathTrie::NodeId cmPathTrie::Insert(std::string const& path)
+{
+  return this->Walk(path, [this](NodeId parent, const char* component,
+                                 std::size_t length) -> NodeId {
+    if (2 * (this->Nodes.size() + 1) > this->Index.size()) {
+      this->Rehash(2 * this->Index.size());
+    }
+    cmStringPool::Handle const handle =
+      this->Components.Intern(component, length);
+    std::size_t const slot = this->FindSlot(parent, handle);
+    if (this->Index[slot] == InvalidNode) {
+      Node const node = { parent, handle, this->Nodes[parent].Depth + 1 };
+      this->Index[slot] = static_cast<NodeId>(this->Nodes.size());
+      this->Nodes.push_back(node);
+    }
+    return this->Index[slot];
+  });
+}
+
+cmPathTrie::NodeId cmPathTrie::Find(std::string const& path) const
+{
+  return this->Walk(path, [this](NodeId parent, const char* component,
+                                 std::size_t length) -> NodeId {
+    cmStringPool::Handle const handle =
+      this->Components.Find(component, length);
+    if (handle == cmStringPool::InvalidHandle) {
+      return InvalidNode;
+    }
+    return this->Index[this->FindSlot(parent, handle)];
+  });
+}
+
+std::string cmPathTrie::GetPath(NodeId id) const
+{
+  std::vector<NodeId> nodes;
+  for (; id != Root; id = this->Nodes[id].Parent) {
+    nodes.push_back(id);
+  }
+  std::string path;
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    Node const& node = this->Nodes[*it];
+    if (node.Depth == 1 && node.Component == cmStringPool::Empty) {
+      path = "/";
+      continue;
+    }
+    if (!path.empty() && path.back() != '/') {
+      path += '/';
+    }
+    path += this->Components.Get(node.Component);
+  }
+  return path;
+}
+
+bool cmPathTrie::IsUnder(NodeId id, NodeId ancestor) const
+{
+  if (id == InvalidNode || ancestor == InvalidNode) {
+    return false;
+  }
+  std::uint32_t const depth = this->Nodes[ancestor].Depth;
+  while (this->Nodes[id].Depth > depth) {
+    id = this->Nodes[id].Parent;
+  }
+  return id == ancestor;
+}
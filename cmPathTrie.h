@@ -0,0 +1,78 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmPathTrie_h
+#define cmPathTrie_h
+
+#include "cmConfigure.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cmStringPool.h"
+
+/** \class cmPathTrie
+ * \brief Trie of slash separated path components.
+ *
+ * Every path is represented by the node of its last component.  Paths
+ * with a common prefix share the nodes of that prefix, and components
+ * are interned, so a sysroot shared by thousands of paths is stored
+ * once.  Nodes are never removed; Reset() releases all of them at once.
+ *
+ * Absolute paths start with an empty component.  Empty components
+ * elsewhere, as from doubled or trailing slashes, are ignored.
+ */
+class cmPathTrie
+{
+  CM_DISABLE_COPY(cmPathTrie)
+
+public:
+  typedef std::uint32_t NodeId;
+
+  // The node of the empty path.
+  static NodeId const Root;
+  static NodeId const InvalidNode;
+
+  cmPathTrie();
+
+  NodeId Insert(std::string const& path);
+
+  // Returns InvalidNode if the path was never inserted.
+  NodeId Find(std::string const& path) const;
+
+  std::string GetPath(NodeId node) const;
+
+  // Whether the path of the node is the path of the ancestor or lies
+  // below it.
+  bool IsUnder(NodeId node, NodeId ancestor) const;
+
+  std::size_t GetNumberOfNodes() const { return this->Nodes.size(); }
+
+  void Reset();
+
+private:
+  struct Node
+  {
+    NodeId Parent;
+    cmStringPool::Handle Component;
+    std::uint32_t Depth;
+  };
+
+  static std::uint32_t Hash(NodeId parent, cmStringPool::Handle component);
+  std::size_t FindSlot(NodeId parent, cmStringPool::Handle component) const;
+  void Rehash(std::size_t size);
+
+  template <typename F>
+  NodeId Walk(std::string const& path, F child) const;
+
+  cmStringPool Components;
+  std::vector<Node> Nodes;
+
+  // Children by parent and component.  Open addressing with linear
+  // probing; the size is a power of two and at least twice the number
+  // of nodes.
+  std::vector<NodeId> Index;
+};
+
+#endif
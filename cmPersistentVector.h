@@ -0,0 +1,109 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmPersistentVector_h
+#define cmPersistentVector_h
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/** \class cmPersistentVector
+ * \brief Vector whose copies share structure.
+ *
+ * The elements live in the leaves of a trie with 32 children per node.
+ * Copying the vector only copies the pointer to the root, so it is O(1).
+ * Modifying an element copies the nodes on the path to it that are
+ * shared with other copies, and modifies nodes owned by this copy in
+ * place.  The copies are not safe to use from different threads.
+ */
+template <typename T>
+class cmPersistentVector
+{
+public:
+  std::size_t size() const { return this->Size; }
+  bool empty() const { return this->Size == 0; }
+
+  T const& operator[](std::size_t i) const
+  {
+    Node const* node = this->Root.get();
+    for (unsigned int shift = this->Shift; shift > 0; shift -= Bits) {
+      node = node->Children[(i >> shift) & Mask].get();
+    }
+    return node->Values[i & Mask];
+  }
+
+  void Set(std::size_t i, T const& value)
+  {
+    Node* node = MakeUnique(this->Root);
+    for (unsigned int shift = this->Shift; shift > 0; shift -= Bits) {
+      node = MakeUnique(node->Children[(i >> shift) & Mask]);
+    }
+    node->Values[i & Mask] = value;
+  }
+
+  void PushBack(T const& value)
+  {
+    if (!this->Root) {
+      this->Root = std::make_shared<Node>();
+    } else if (this->Size == (std::size_t(Width) << this->Shift)) {
+      // The trie is full, grow it by one level at the top.
+      std::shared_ptr<Node> root = std::make_shared<Node>();
+      root->Children.push_back(std::move(this->Root));
+      this->Root = std::move(root);
+      this->Shift += Bits;
+    }
+    Node* node = MakeUnique(this->Root);
+    for (unsigned int shift = this->Shift; shift > 0; shift -= Bits) {
+      std::size_t const index = (this->Size >> shift) & Mask;
+      if (index == node->Children.size()) {
+        node->Children.push_back(std::make_shared<Node>());
+      }
+      node = MakeUnique(node->Children[index]);
+    }
+    node->Values.push_back(value);
+    ++this->Size;
+  }
+
+  void clear()
+  {
+    this->Root.reset();
+    this->Size = 0;
+    this->Shift = 0;
+  }
+
+  // Whether both vectors are copies of each other without modifications.
+  bool IsSameAs(cmPersistentVector const& other) const
+  {
+    return this->Root == other.Root;
+  }
+
+private:
+  enum
+  {
+    Bits = 5,
+    Width = 1 << Bits,
+    Mask = Width - 1
+  };
+
+  struct Node
+  {
+    std::vector<std::shared_ptr<Node>> Children;
+    std::vector<T> Values;
+  };
+
+  // Nodes referenced only by this vector may be modified in place.
+  static Node* MakeUnique(std::shared_ptr<Node>& node)
+  {
+    if (node.use_count() != 1) {
+      node = std::make_shared<Node>(*node);
+    }
+    return node.get();
+  }
+
+  std::shared_ptr<Node> Root;
+  std::size_t Size = 0;
+  unsigned int Shift = 0;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmSessionMetrics.h"
+
+#include <json/writer.h>
+
+#include "cmVersion.h"
+#include "cmsys/FStream.hxx"
+
+namespace {
+
+int bucket_index(std::uint64_t us)
+{
+  int i = 0;
+  while (us != 0 && i < cmSessionMetrics::Histogram::NumberOfBuckets - 1) {
+    us >>= 1;
+    ++i;
+  }
+  return i;
+}
+
+Json::UInt64 to_us(std::uint64_t ns)
+{
+  return static_cast<Json::UInt64>(ns / 1000);
+}
+
+} // namespace
+
+void cmSessionMetrics::Histogram::Add(std::uint64_t ns)
+{
+  this->Buckets[bucket_index(ns / 1000)] += 1;
+  if (this->Count == 0 || ns < this->Min) {
+    this->Min = ns;
+  }
+  if (ns > this->Max) {
+    this->Max = ns;
+  }
+  this->Count += 1;
+  this->Sum += ns;
+}
+
+// Upper bound of the bucket that holds the given quantile.
+std::uint64_t cmSessionMetrics::Histogram::Quantile(double q) const
+{
+  std::uint64_t const rank = static_cast<std::uint64_t>(q * this->Count);
+  std::uint64_t seen = 0;
+  for (int i = 0; i < NumberOfBuckets; ++i) {
+    seen += this->Buckets[i];
+    if (seen > rank) {
+      return (std::uint64_t(1) << i) * 1000;
+    }
+  }
+  return this->Max;
+}
+
+Json::Value cmSessionMetrics::Histogram::ToJson() const
+{
+  Json::Value value = Json::objectValue;
+  value["count"] = static_cast<Json::UInt64>(this->Count);
+  if (this->Count == 0) {
+    return value;
+  }
+  value["sum_us"] = to_us(this->Sum);
+  value["min_us"] = to_us(this->Min);
+  value["max_us"] = to_us(this->Max);
+  value["mean_us"] = to_us(this->Sum / this->Count);
+  value["p50_us"] = to_us(this->Quantile(0.5));
+  value["p90_us"] = to_us(this->Quantile(0.9));
+  value["p99_us"] = to_us(this->Quantile(0.99));
+
+  Json::Value& buckets = value["buckets"] = Json::arrayValue;
+  for (int i = 0; i < NumberOfBuckets; ++i) {
+    if (this->Buckets[i] == 0) {
+      continue;
+    }
+    Json::Value bucket = Json::objectValue;
+    bucket["lt_us"] = static_cast<Json::UInt64>(std::uint64_t(1) << i);
+    bucket["count"] = static_cast<Json::UInt64>(this->Buckets[i]);
+    buckets.append(bucket);
+  }
+  return value;
+}
+
+bool cmSessionMetrics::Write(std::string const& file) const
+{
+  cmsys::ofstream fout(file.c_str());
+  if (!fout) {
+    return false;
+  }
+  this->WriteJSON(fout);
+  return static_cast<bool>(fout);
+}
+
+void cmSessionMetrics::WriteJSON(std::ostream& os) const
+{
+  Json::Value requests = Json::objectValue;
+  for (auto const& request : this->Requests) {
+    Json::Value value = Json::objectValue;
+    value["bytes_received"] =
+      static_cast<Json::UInt64>(request.second.BytesReceived);
+    value["latency"] = request.second.Latency.ToJson();
+    value["parse"] = request.second.Parse.ToJson();
+    value["ingest"] = request.second.Ingest.ToJson();
+    value["ui_rebuild"] = request.second.UIRebuild.ToJson();
+    requests[request.first] = value;
+  }
+
+  Json::Value terminal = Json::objectValue;
+  terminal["updates"] = static_cast<Json::UInt64>(this->Screen.Updates);
+  terminal["bytes_written"] =
+    static_cast<Json::UInt64>(this->Screen.BytesWritten);
+
+  Json::Value cache = Json::objectValue;
+  cache["entries"] = static_cast<Json::UInt64>(this->CacheSize.Entries);
+  cache["strings"] = static_cast<Json::UInt64>(this->CacheSize.Strings);
+  cache["pool_bytes"] = static_cast<Json::UInt64>(this->CacheSize.PoolBytes);
+
+  Json::Value root = Json::objectValue;
+  root["cmake_version"] = cmVersion::GetCMakeVersion();
+  root["requests"] = requests;
+  root["terminal"] = terminal;
+  root["cache"] = cache;
+  Json::StyledStreamWriter writer;
+  writer.write(os, root);
+}
@@ -0,0 +1,84 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmSessionMetrics_h
+#define cmSessionMetrics_h
+
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+#include <json/value.h>
+
+/** \class cmSessionMetrics
+ * \brief Counters and latency histograms per server request type.
+ *
+ * Recording a sample is a handful of integer operations, so the
+ * metrics are always collected and only written out on request.
+ */
+class cmSessionMetrics
+{
+public:
+  // Durations in bucket i are below 2^i microseconds.
+  class Histogram
+  {
+  public:
+    enum
+    {
+      NumberOfBuckets = 40
+    };
+
+    void Add(std::uint64_t ns);
+
+    std::uint64_t GetCount() const { return this->Count; }
+
+    Json::Value ToJson() const;
+
+  private:
+    std::uint64_t Quantile(double q) const;
+
+    std::uint64_t Buckets[NumberOfBuckets] = {};
+    std::uint64_t Count = 0;
+    std::uint64_t Sum = 0;
+    std::uint64_t Min = 0;
+    std::uint64_t Max = 0;
+  };
+
+  struct Request
+  {
+    std::uint64_t BytesReceived = 0;
+    Histogram Latency;   // request sent until reply received
+    Histogram Parse;     // JSON parsing of the server packets
+    Histogram Ingest;    // copying the reply into cmState
+    Histogram UIRebuild; // recreating the widgets afterwards
+  };
+
+  // Output of the curses interface.
+  struct Terminal
+  {
+    std::uint64_t Updates = 0;
+    std::uint64_t BytesWritten = 0;
+  };
+
+  // Size of the cache at the end of the session.
+  struct Cache
+  {
+    std::uint64_t Entries = 0;
+    std::uint64_t Strings = 0;   // distinct strings in the pool
+    std::uint64_t PoolBytes = 0; // allocated by the pool
+  };
+
+  Request& Get(std::string const& type) { return this->Requests[type]; }
+  Terminal& GetTerminal() { return this->Screen; }
+  Cache& GetCache() { return this->CacheSize; }
+
+  bool Write(std::string const& file) const;
+  void WriteJSON(std::ostream& os) const;
+
+private:
+  std::map<std::string, Request> Requests;
+  Terminal Screen;
+  Cache CacheSize;
+};
+
+#endif
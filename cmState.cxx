@@ -3,85 +3,634 @@
 
 #include "cmState.h"
 
-std::vector<std::string> cmState::GetCacheEntryKeys() const
+#include <algorithm>
+#include <cstring>
+
+#include "cmSystemTools.h"
+
+namespace {
+
+const char* const cache_entry_type_names[]{
+  "BOOL", "PATH", "FILEPATH", "STRING", "INTERNAL", "STATIC", "UNINITIALIZED"};
+
+constexpr const char* cache_entry_property_names[]{
+  "ADVANCED", "HELPSTRING", "MODIFIED", "STRINGS", "TYPE", "VALUE"};
+
+static_assert(sizeof(cache_entry_property_names) /
+                  sizeof(cache_entry_property_names[0]) ==
+                cmStateEnums::OTHER_PROPERTY,
+              "A name is needed for every cache entry property.");
+
+} // namespace
+
+cmState::EntryId const cmState::InvalidEntry = static_cast<EntryId>(-1);
+
+const char* cmState::CacheEntryTypeToString(cmStateEnums::CacheEntryType type)
 {
-  std::vector<std::string> definitions;
-  definitions.reserve(this->Cache.size());
-  for (auto const& entry : this->Cache) {
-    definitions.push_back(entry.first);
+  if (type < cmStateEnums::BOOL || type > cmStateEnums::UNINITIALIZED) {
+    type = cmStateEnums::UNINITIALIZED;
   }
-  return definitions;
+  return cache_entry_type_names[type];
 }
 
-const char* cmState::GetCacheEntryValue(std::string const& key) const
+cmStateEnums::CacheEntryType cmState::StringToCacheEntryType(
+  std::string const& str)
 {
-  auto const i = this->Cache.find(key);
-  if (i == this->Cache.end()) {
+  for (int i = cmStateEnums::BOOL; i != cmStateEnums::UNINITIALIZED; ++i) {
+    if (str == cache_entry_type_names[i]) {
+      return static_cast<cmStateEnums::CacheEntryType>(i);
+    }
+  }
+  return cmStateEnums::UNINITIALIZED;
+}
+
+const char* cmState::CacheEntryPropertyToString(
+  cmStateEnums::CacheEntryProperty property)
+{
+  if (property < cmStateEnums::ADVANCED ||
+      property >= cmStateEnums::OTHER_PROPERTY) {
     return nullptr;
   }
-  return i->second.Value.c_str();
+  return cache_entry_property_names[property];
 }
 
-cmStateEnums::CacheEntryType cmState::GetCacheEntryType(
-  std::string const& key) const
+cmStateEnums::CacheEntryProperty cmState::StringToCacheEntryProperty(
+  std::string const& str)
+{
+  // The names start with different letters, so the first one picks the
+  // only name to compare with.
+  cmStateEnums::CacheEntryProperty property;
+  switch (str.empty() ? '\0' : str[0]) {
+    case 'A':
+      property = cmStateEnums::ADVANCED;
+      break;
+    case 'H':
+      property = cmStateEnums::HELPSTRING;
+      break;
+    case 'M':
+      property = cmStateEnums::MODIFIED;
+      break;
+    case 'S':
+      property = cmStateEnums::STRINGS;
+      break;
+    case 'T':
+      property = cmStateEnums::TYPE;
+      break;
+    case 'V':
+      property = cmStateEnums::VALUE;
+      break;
+    default:
+      return cmStateEnums::OTHER_PROPERTY;
+  }
+  return str == cache_entry_property_names[property]
+    ? property
+    : cmStateEnums::OTHER_PROPERTY;
+}
+
+std::shared_ptr<cmState::CacheLayout> cmState::NewLayout()
 {
-  auto const i = this->Cache.find(key);
-  if (i == this->Cache.end()) {
-    return cmStateEnums::UNINITIALIZED;
+  std::shared_ptr<CacheLayout> layout = std::make_shared<CacheLayout>();
+  layout->Pool = std::make_shared<cmStringPool>();
+  layout->Paths = std::make_shared<cmPathTrie>();
+  layout->Words = std::make_shared<cmTrigramIndex>();
+  layout->On = layout->Pool->Intern("ON", 2);
+  return layout;
+}
+
+cmState::CacheLayout& cmState::MutableLayout()
+{
+  if (this->Layout.use_count() != 1) {
+    this->Layout = std::make_shared<CacheLayout>(*this->Layout);
+  }
+  return *this->Layout;
+}
+
+cmState::Snapshot cmState::TakeSnapshot() const
+{
+  Snapshot snapshot;
+  snapshot.Layout = this->Layout;
+  snapshot.States = this->States;
+  return snapshot;
+}
+
+void cmState::RestoreSnapshot(Snapshot const& snapshot)
+{
+  // MutableLayout() copies the layout before it is modified again.
+  this->Layout = std::const_pointer_cast<CacheLayout>(snapshot.Layout);
+  this->States = snapshot.States;
+}
+
+void cmState::AddRemovedCacheEntries(Snapshot const& snapshot)
+{
+  CacheLayout const& from = *snapshot.Layout;
+  std::vector<EntryId> missing;
+  EntryId const numberOfEntries =
+    static_cast<EntryId>(snapshot.GetNumberOfCacheEntries());
+  for (EntryId id = 0; id < numberOfEntries; ++id) {
+    cmStringPool::Handle const key = from.Keys[id];
+    if (FindInIndex(*this->Layout, from.Pool->Get(key),
+                    from.Pool->GetLength(key)) == InvalidEntry) {
+      missing.push_back(id);
+    }
+  }
+  if (missing.empty()) {
+    return;
+  }
+
+  CacheLayout& layout = this->MutableLayout();
+  cmStringPool& pool = *layout.Pool;
+  std::size_t const size = layout.Keys.size() + missing.size();
+  std::size_t indexSize = layout.Index.empty() ? 64 : layout.Index.size();
+  while (2 * size > indexSize) {
+    indexSize *= 2;
+  }
+  cmStringPool const& fromPool = *from.Pool;
+  for (std::vector<EntryId>::const_iterator it = missing.begin();
+       it != missing.end(); ++it) {
+    cmStringPool::Handle const key = from.Keys[*it];
+    cmStringPool::Handle const value = snapshot.States[*it].Value;
+    cmStringPool::Handle const canonical = snapshot.States[*it].Canonical;
+    layout.Keys.push_back(
+      pool.Intern(fromPool.Get(key), fromPool.GetLength(key)));
+    layout.Types.push_back(from.Types[*it]);
+    layout.HelpStrings.push_back(cmStringPool::Empty);
+    layout.Strings.push_back(cmStringPool::Empty);
+    layout.StringsItems.emplace_back();
+    layout.Bags.push_back(InvalidEntry);
+    EntryState const state = {
+      pool.Intern(fromPool.Get(value), fromPool.GetLength(value)),
+      pool.Intern(fromPool.Get(canonical), fromPool.GetLength(canonical)),
+      cmPathTrie::InvalidNode, FlagRemoved
+    };
+    this->States.PushBack(state);
+  }
+  this->Rehash(layout, indexSize);
+}
+
+std::string cmState::CanonicalCacheEntryValue(
+  cmStateEnums::CacheEntryType type, std::string const& value)
+{
+  std::string out = value.substr(0, value.find_last_not_of(' ') + 1);
+  if (type == cmStateEnums::PATH || type == cmStateEnums::FILEPATH) {
+    cmSystemTools::ConvertToUnixSlashes(out);
+  }
+  if (type == cmStateEnums::BOOL) {
+    out = cmSystemTools::IsOn(out) ? "ON" : "OFF";
+  }
+  return out;
+}
+
+void cmState::InternValue(EntryState& state, cmStateEnums::CacheEntryType type,
+                          std::string const& value)
+{
+  CacheLayout const& layout = *this->Layout;
+  state.Value = layout.Pool->Intern(value);
+  // BOOL entries that are on get the handle of ON, which is interned
+  // already.
+  std::string const canonical = CanonicalCacheEntryValue(type, value);
+  state.Canonical = layout.Pool->Intern(canonical);
+  state.Path = cmPathTrie::InvalidNode;
+  if (type == cmStateEnums::PATH || type == cmStateEnums::FILEPATH) {
+    state.Path = layout.Paths->Insert(canonical);
+  }
+}
+
+std::vector<cmState::EntryId> cmState::FindCacheEntriesUnderPath(
+  std::string const& path) const
+{
+  std::vector<EntryId> ids;
+  cmPathTrie const& paths = *this->Layout->Paths;
+  cmPathTrie::NodeId const node =
+    paths.Find(CanonicalCacheEntryValue(cmStateEnums::PATH, path));
+  if (node == cmPathTrie::InvalidNode) {
+    return ids;
+  }
+  EntryId const numberOfEntries =
+    static_cast<EntryId>(this->GetNumberOfCacheEntries());
+  for (EntryId id = 0; id < numberOfEntries; ++id) {
+    if (paths.IsUnder(this->States[id].Path, node)) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+cmState::EntryId cmState::AddCacheEntry(
+  std::string const& key, cmStateEnums::CacheEntryType type,
+  std::string const& value)
+{
+  CacheLayout& layout = this->MutableLayout();
+  cmStringPool& pool = *layout.Pool;
+
+  EntryId id = this->FindCacheEntry(key);
+  if (id != InvalidEntry) {
+    layout.Types[id] = type;
+    EntryState state = this->States[id];
+    this->InternValue(state, type, value);
+    this->States.Set(id, state);
+    layout.Words->Add(id, pool.Get(state.Value));
+    return id;
+  }
+
+  if (2 * (layout.Keys.size() + 1) > layout.Index.size()) {
+    this->Rehash(layout, layout.Index.empty() ? 64 : 2 * layout.Index.size());
+  }
+
+  id = static_cast<EntryId>(layout.Keys.size());
+  cmStringPool::Handle const keyHandle = pool.Intern(key);
+  layout.Keys.push_back(keyHandle);
+  layout.Types.push_back(type);
+  layout.HelpStrings.push_back(cmStringPool::Empty);
+  layout.Strings.push_back(cmStringPool::Empty);
+  layout.StringsItems.emplace_back();
+  layout.Bags.push_back(InvalidEntry);
+  EntryState state = { cmStringPool::Empty, cmStringPool::Empty,
+                       cmPathTrie::InvalidNode, 0 };
+  this->InternValue(state, type, value);
+  this->States.PushBack(state);
+  layout.Words->Add(id, pool.Get(keyHandle));
+  layout.Words->Add(id, pool.Get(state.Value));
+
+  std::size_t const mask = layout.Index.size() - 1;
+  std::size_t slot = pool.GetHash(keyHandle) & mask;
+  while (layout.Index[slot] != InvalidEntry) {
+    slot = (slot + 1) & mask;
+  }
+  layout.Index[slot] = id;
+  return id;
+}
+
+void cmState::Rehash(CacheLayout& layout, std::size_t size)
+{
+  layout.Index.assign(size, InvalidEntry);
+  std::size_t const mask = size - 1;
+  for (EntryId id = 0; id < layout.Keys.size(); ++id) {
+    std::size_t slot = layout.Pool->GetHash(layout.Keys[id]) & mask;
+    while (layout.Index[slot] != InvalidEntry) {
+      slot = (slot + 1) & mask;
+    }
+    layout.Index[slot] = id;
+  }
+}
+
+cmState::EntryId cmState::FindCacheEntry(std::string const& key) const
+{
+  return this->FindCacheEntry(key.data(), key.size());
+}
+
+cmState::EntryId cmState::FindCacheEntry(
+  const char* key, std::size_t length) const
+{
+  return FindInIndex(*this->Layout, key, length);
+}
+
+cmState::EntryId cmState::FindInIndex(CacheLayout const& layout,
+                                      const char* key, std::size_t length)
+{
+  if (layout.Index.empty()) {
+    return InvalidEntry;
+  }
+  cmStringPool const& pool = *layout.Pool;
+  std::uint32_t const hash = cmStringPool::Hash(key, length);
+  std::size_t const mask = layout.Index.size() - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    EntryId const id = layout.Index[slot];
+    if (id == InvalidEntry) {
+      return InvalidEntry;
+    }
+    cmStringPool::Handle const candidate = layout.Keys[id];
+    if (pool.GetHash(candidate) == hash &&
+        pool.GetLength(candidate) == length &&
+        std::memcmp(pool.Get(candidate), key, length) == 0) {
+      return id;
+    }
   }
-  return i->second.Type;
+}
+
+cmState::CacheEntry cmState::GetCacheEntry(EntryId id) const
+{
+  CacheLayout const& layout = *this->Layout;
+  CacheEntry entry;
+  entry.Value = this->GetCacheEntryValue(id);
+  entry.Type = layout.Types[id];
+  entry.HelpString = layout.Pool->Get(layout.HelpStrings[id]);
+  entry.Strings = layout.Pool->Get(layout.Strings[id]);
+  entry.IsAdvanced = this->GetCacheEntryFlag(id, FlagAdvanced);
+  entry.IsModified = this->GetCacheEntryFlag(id, FlagModified);
+  entry.IsRemoved = this->GetCacheEntryFlag(id, FlagRemoved);
+  return entry;
 }
 
 const char* cmState::GetCacheEntryProperty(
-  std::string const& key, std::string const& propertyName) const
+  EntryId id, cmStateEnums::CacheEntryProperty property) const
 {
-  auto const i = this->Cache.find(key);
-  if (i == this->Cache.end()) {
-    return nullptr;
+  CacheLayout const& layout = *this->Layout;
+  switch (property) {
+    case cmStateEnums::ADVANCED:
+      return this->GetCacheEntryFlag(id, FlagAdvanced) ? "1" : nullptr;
+    case cmStateEnums::HELPSTRING:
+      return layout.Pool->Get(layout.HelpStrings[id]);
+    case cmStateEnums::MODIFIED:
+      return this->GetCacheEntryFlag(id, FlagModified) ? "1" : nullptr;
+    case cmStateEnums::STRINGS:
+      if (layout.Strings[id] == cmStringPool::Empty) {
+        return nullptr;
+      }
+      return layout.Pool->Get(layout.Strings[id]);
+    case cmStateEnums::TYPE:
+      return CacheEntryTypeToString(layout.Types[id]);
+    case cmStateEnums::VALUE:
+      return this->GetCacheEntryValue(id);
+    case cmStateEnums::OTHER_PROPERTY:
+      break;
   }
-  if (propertyName == "STRINGS") {
-    return i->second.Strings.empty() ? nullptr : i->second.Strings.c_str();
+  return nullptr;
+}
+
+const char* cmState::GetCacheEntryProperty(
+  EntryId id, std::string const& propertyName) const
+{
+  cmStateEnums::CacheEntryProperty const property =
+    StringToCacheEntryProperty(propertyName);
+  if (property == cmStateEnums::OTHER_PROPERTY) {
+    return this->GetBagProperty(this->Layout->Bags[id], propertyName);
   }
-  if (propertyName == "HELPSTRING") {
-    return i->second.HelpString.c_str();
+  return this->GetCacheEntryProperty(id, property);
+}
+
+void cmState::SetCacheEntryProperty(
+  EntryId id, cmStateEnums::CacheEntryProperty property,
+  std::string const& value)
+{
+  switch (property) {
+    case cmStateEnums::ADVANCED:
+      this->SetCacheEntryFlag(id, FlagAdvanced, cmSystemTools::IsOn(value));
+      break;
+    case cmStateEnums::HELPSTRING: {
+      CacheLayout& layout = this->MutableLayout();
+      layout.HelpStrings[id] = layout.Pool->Intern(value);
+      layout.Words->Add(id, layout.Pool->Get(layout.HelpStrings[id]));
+    } break;
+    case cmStateEnums::MODIFIED:
+      this->SetCacheEntryFlag(id, FlagModified, cmSystemTools::IsOn(value));
+      break;
+    case cmStateEnums::STRINGS: {
+      CacheLayout& layout = this->MutableLayout();
+      layout.Strings[id] = layout.Pool->Intern(value);
+      std::vector<std::string> items;
+      cmSystemTools::ExpandListArgument(value, items);
+      std::vector<cmStringPool::Handle>& handles = layout.StringsItems[id];
+      handles.clear();
+      for (std::string const& item : items) {
+        handles.push_back(layout.Pool->Intern(item));
+      }
+    } break;
+    case cmStateEnums::TYPE: {
+      cmStateEnums::CacheEntryType const type = StringToCacheEntryType(value);
+      this->MutableLayout().Types[id] = type;
+      // The canonical value depends on the type.
+      EntryState state = this->States[id];
+      this->InternValue(state, type, this->GetCacheEntryValue(id));
+      this->States.Set(id, state);
+    } break;
+    case cmStateEnums::VALUE:
+      this->SetCacheEntryValue(id, value);
+      break;
+    case cmStateEnums::OTHER_PROPERTY:
+      break;
+  }
+}
+
+void cmState::SetCacheEntryProperty(
+  EntryId id, std::string const& propertyName, std::string const& value)
+{
+  cmStateEnums::CacheEntryProperty const property =
+    StringToCacheEntryProperty(propertyName);
+  if (property == cmStateEnums::OTHER_PROPERTY) {
+    this->SetBagProperty(
+      this->MutableLayout().Bags[id], propertyName, value);
+  } else {
+    this->SetCacheEntryProperty(id, property, value);
+  }
+}
+
+const char* cmState::GetBagProperty(std::uint32_t bag,
+                                    std::string const& name) const
+{
+  CacheLayout const& layout = *this->Layout;
+  // A name that was never interned cannot be in any bag.
+  cmStringPool::Handle const handle =
+    layout.Pool->Find(name.data(), name.size());
+  if (handle == cmStringPool::InvalidHandle) {
+    return nullptr;
+  }
+  for (std::uint32_t item = bag; item != InvalidEntry;
+       item = layout.BagItems[item].Next) {
+    if (layout.BagItems[item].Name == handle) {
+      return layout.Pool->Get(layout.BagItems[item].Value);
+    }
   }
   return nullptr;
 }
 
+// The bag must belong to the layout returned by MutableLayout().
+void cmState::SetBagProperty(std::uint32_t& bag, std::string const& name,
+                             std::string const& value)
+{
+  CacheLayout& layout = *this->Layout;
+  cmStringPool::Handle const handle = layout.Pool->Intern(name);
+  for (std::uint32_t item = bag; item != InvalidEntry;
+       item = layout.BagItems[item].Next) {
+    if (layout.BagItems[item].Name == handle) {
+      layout.BagItems[item].Value = layout.Pool->Intern(value);
+      return;
+    }
+  }
+  BagItem const item = { handle, layout.Pool->Intern(value), bag };
+  bag = static_cast<std::uint32_t>(layout.BagItems.size());
+  layout.BagItems.push_back(item);
+}
+
+std::size_t cmState::AddHiddenCacheEntry(
+  std::string const& key, cmStateEnums::CacheEntryType type,
+  std::string const& value)
+{
+  CacheLayout& layout = this->MutableLayout();
+  cmStringPool& pool = *layout.Pool;
+  auto const byKey = [&pool](HiddenEntry const& entry, const char* k) {
+    return strcmp(pool.Get(entry.Key), k) < 0;
+  };
+  // Entries usually arrive in key order and are simply appended.
+  auto it = layout.Hidden.end();
+  if (!layout.Hidden.empty() && !byKey(layout.Hidden.back(), key.c_str())) {
+    it = std::lower_bound(
+      layout.Hidden.begin(), layout.Hidden.end(), key.c_str(), byKey);
+    if (key == pool.Get(it->Key)) {
+      it->Type = type;
+      it->Value = pool.Intern(value);
+      return static_cast<std::size_t>(it - layout.Hidden.begin());
+    }
+  }
+  HiddenEntry const entry = { pool.Intern(key), pool.Intern(value),
+                              InvalidEntry, type };
+  it = layout.Hidden.insert(it, entry);
+  return static_cast<std::size_t>(it - layout.Hidden.begin());
+}
+
+std::size_t cmState::FindHiddenCacheEntry(std::string const& key) const
+{
+  CacheLayout const& layout = *this->Layout;
+  cmStringPool const& pool = *layout.Pool;
+  auto const it = std::lower_bound(
+    layout.Hidden.begin(), layout.Hidden.end(), key.c_str(),
+    [&pool](HiddenEntry const& entry, const char* k) {
+      return strcmp(pool.Get(entry.Key), k) < 0;
+    });
+  if (it == layout.Hidden.end() || key != pool.Get(it->Key)) {
+    return layout.Hidden.size();
+  }
+  return static_cast<std::size_t>(it - layout.Hidden.begin());
+}
+
+cmState::CacheEntry cmState::GetHiddenCacheEntry(std::size_t index) const
+{
+  HiddenEntry const& hidden = this->Layout->Hidden[index];
+  CacheEntry entry;
+  entry.Value = this->Layout->Pool->Get(hidden.Value);
+  entry.Type = hidden.Type;
+  if (const char* help = this->GetBagProperty(hidden.Bag, "HELPSTRING")) {
+    entry.HelpString = help;
+  }
+  return entry;
+}
+
+const char* cmState::GetHiddenCacheEntryProperty(
+  std::size_t index, std::string const& propertyName) const
+{
+  HiddenEntry const& hidden = this->Layout->Hidden[index];
+  switch (StringToCacheEntryProperty(propertyName)) {
+    case cmStateEnums::TYPE:
+      return CacheEntryTypeToString(hidden.Type);
+    case cmStateEnums::VALUE:
+      return this->Layout->Pool->Get(hidden.Value);
+    default:
+      return this->GetBagProperty(hidden.Bag, propertyName);
+  }
+}
+
+void cmState::SetHiddenCacheEntryProperty(
+  std::size_t index, std::string const& propertyName, std::string const& value)
+{
+  CacheLayout& layout = this->MutableLayout();
+  HiddenEntry& hidden = layout.Hidden[index];
+  switch (StringToCacheEntryProperty(propertyName)) {
+    case cmStateEnums::TYPE:
+      hidden.Type = StringToCacheEntryType(value);
+      break;
+    case cmStateEnums::VALUE:
+      hidden.Value = layout.Pool->Intern(value);
+      break;
+    default:
+      this->SetBagProperty(hidden.Bag, propertyName, value);
+      break;
+  }
+}
+
+void cmState::SetCacheEntryFlag(EntryId id, CacheEntryFlag flag, bool value)
+{
+  EntryState state = this->States[id];
+  unsigned char const flags = value
+    ? static_cast<unsigned char>(state.Flags | flag)
+    : static_cast<unsigned char>(state.Flags & ~flag);
+  if (flags != state.Flags) {
+    state.Flags = flags;
+    this->States.Set(id, state);
+  }
+}
+
+void cmState::SetCacheEntryValue(EntryId id, std::string const& value)
+{
+  EntryState state = this->States[id];
+  this->InternValue(state, this->Layout->Types[id], value);
+  this->States.Set(id, state);
+  this->Layout->Words->Add(id, value.c_str());
+}
+
+const char* cmState::GetCacheEntryValue(std::string const& key) const
+{
+  EntryId const id = this->FindCacheEntry(key);
+  if (id == InvalidEntry) {
+    std::size_t const index = this->FindHiddenCacheEntry(key);
+    if (index == this->Layout->Hidden.size()) {
+      return nullptr;
+    }
+    return this->Layout->Pool->Get(this->Layout->Hidden[index].Value);
+  }
+  return this->GetCacheEntryValue(id);
+}
+
+cmStateEnums::CacheEntryType cmState::GetCacheEntryType(
+  std::string const& key) const
+{
+  EntryId const id = this->FindCacheEntry(key);
+  if (id == InvalidEntry) {
+    std::size_t const index = this->FindHiddenCacheEntry(key);
+    if (index == this->Layout->Hidden.size()) {
+      return cmStateEnums::UNINITIALIZED;
+    }
+    return this->Layout->Hidden[index].Type;
+  }
+  return this->GetCacheEntryType(id);
+}
+
+const char* cmState::GetCacheEntryProperty(
+  std::string const& key, std::string const& propertyName) const
+{
+  EntryId const id = this->FindCacheEntry(key);
+  if (id == InvalidEntry) {
+    std::size_t const index = this->FindHiddenCacheEntry(key);
+    if (index == this->Layout->Hidden.size()) {
+      return nullptr;
+    }
+    return this->GetHiddenCacheEntryProperty(index, propertyName);
+  }
+  return this->GetCacheEntryProperty(id, propertyName);
+}
+
 bool cmState::GetCacheEntryPropertyAsBool(
   std::string const& key, std::string const& propertyName) const
 {
-  auto const i = this->Cache.find(key);
-  if (i == this->Cache.end()) {
+  EntryId const id = this->FindCacheEntry(key);
+  if (id == InvalidEntry) {
     return false;
   }
-  if (propertyName == "ADVANCED") {
-    return i->second.IsAdvanced;
-  }
-  return false;
+  const char* value = this->GetCacheEntryProperty(id, propertyName);
+  return value && cmSystemTools::IsOn(value);
 }
 
 void cmState::RemoveCacheEntry(std::string const& key)
 {
-  auto const i = this->Cache.find(key);
-  if (i != this->Cache.end()) {
-    i->second.IsRemoved = true;
+  EntryId const id = this->FindCacheEntry(key);
+  if (id != InvalidEntry) {
+    this->SetCacheEntryFlag(id, FlagRemoved, true);
   }
 }
 
 void cmState::SetCacheEntryBoolProperty(
   std::string const& key, std::string const& propertyName, bool value)
 {
-  if (propertyName == "ADVANCED") {
-    this->Cache[key].IsAdvanced = value;
-  }
-  if (propertyName == "MODIFIED") {
-    this->Cache[key].IsModified = value;
+  EntryId const id = this->FindCacheEntry(key);
+  if (id == InvalidEntry) {
+    return;
   }
+  this->SetCacheEntryProperty(id, propertyName, value ? "ON" : "OFF");
 }
 
 void cmState::SetCacheEntryValue(
   std::string const& key, std::string const& value)
 {
-  this->Cache[key].Value = value;
+  EntryId const id = this->FindCacheEntry(key);
+  if (id != InvalidEntry) {
+    this->SetCacheEntryValue(id, value);
+  }
 }
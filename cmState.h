@@ -3,29 +3,215 @@
 #ifndef cmState_h
 #define cmState_h
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "cmPathTrie.h"
+#include "cmPersistentVector.h"
 #include "cmStateTypes.h"
+#include "cmStringPool.h"
+#include "cmTrigramIndex.h"
 
+/** \class cmState
+ * \brief The cache as reported by the server.
+ *
+ * Entries are numbered densely in the order they were added and their
+ * attributes are kept in one array per attribute, so passes over all
+ * entries read contiguous memory.  Keys are found through an open
+ * addressing hash table.  Ids stay valid until the cache is cleared.
+ *
+ * Keys, values, help strings and STRINGS lists are interned in a string
+ * pool, so identical strings are stored once.  Clearing the cache starts
+ * a new pool; one that is still shared with its users is left to them.
+ *
+ * INTERNAL and STATIC entries are never shown, so they do not get an id.
+ * They are kept in a compact table sorted by key, with all their
+ * properties in the property bag.
+ *
+ * Values are parsed once when they are set: every entry also keeps the
+ * canonical form of its value (ON or OFF for BOOL entries, forward
+ * slashes for paths, no trailing blanks) and STRINGS lists are split
+ * into their items when they are set.  The canonical values of PATH and
+ * FILEPATH entries are also inserted into a trie of path components
+ * shared by all snapshots, so entries below a directory are found
+ * without comparing strings.
+ *
+ * The words of the keys, values and help strings are indexed by their
+ * trigrams as they are set, for searching.  Like the trie, the index is
+ * shared by all snapshots and only grows, so it may list entries whose
+ * current text no longer matches.
+ *
+ * Everything but the values and flags of the entries is fixed once the
+ * cache is read and shared by all snapshots of the same cache.  Values
+ * and flags are kept in a persistent vector, so taking a snapshot is
+ * O(1) and editing an entry copies only a few small nodes.
+ */
 class cmState
 {
 public:
+  typedef std::uint32_t EntryId;
+  static EntryId const InvalidEntry;
+
+  enum CacheEntryFlag
+  {
+    FlagAdvanced = 1 << 0, // hidden per default
+    FlagModified = 1 << 1, // value was modified, show in bold
+    FlagRemoved = 1 << 2,  // value was flagged for removal
+    FlagNew = 1 << 3       // entry first appeared in the last configure
+  };
+
+  // A copy of one entry, detached from the state.
   struct CacheEntry
   {
     std::string Value;
-    cmStateEnums::CacheEntryType Type;
-    std::string HelpString;  // string to show as tooltip
-    std::string Strings;     // dropdown values, separated by ;
-    bool IsAdvanced = false; // hidden per default
-    bool IsModified = false; // value was modified, show in bold
-    bool IsRemoved = false;  // value was flagged for removal
+    cmStateEnums::CacheEntryType Type = cmStateEnums::UNINITIALIZED;
+    std::string HelpString; // string to show as tooltip
+    std::string Strings;    // dropdown values, separated by ;
+    bool IsAdvanced = false;
+    bool IsModified = false;
+    bool IsRemoved = false;
   };
 
-  std::map<std::string, CacheEntry>& GetCache() { return this->Cache; }
+  static const char* CacheEntryTypeToString(cmStateEnums::CacheEntryType type);
+  static cmStateEnums::CacheEntryType StringToCacheEntryType(
+    std::string const& str);
+
+  static const char* CacheEntryPropertyToString(
+    cmStateEnums::CacheEntryProperty property);
+  // Returns OTHER_PROPERTY for names without dedicated storage.
+  static cmStateEnums::CacheEntryProperty StringToCacheEntryProperty(
+    std::string const& str);
+
+  // The form in which values of the type are compared and stored
+  // after editing.
+  static std::string CanonicalCacheEntryValue(
+    cmStateEnums::CacheEntryType type, std::string const& value);
+
+  // Whether entries of this type go to the table of hidden entries.
+  static bool IsHiddenType(cmStateEnums::CacheEntryType type)
+  {
+    return type == cmStateEnums::INTERNAL || type == cmStateEnums::STATIC;
+  }
+
+  // Add an entry, or replace type and value of an existing one.  Hidden
+  // entries must be added with AddHiddenCacheEntry instead.
+  EntryId AddCacheEntry(
+    std::string const& key, cmStateEnums::CacheEntryType type,
+    std::string const& value);
+
+  std::size_t GetNumberOfCacheEntries() const
+  {
+    return this->Layout->Keys.size();
+  }
+
+  EntryId FindCacheEntry(std::string const& key) const;
+  EntryId FindCacheEntry(const char* key, std::size_t length) const;
+
+  CacheEntry GetCacheEntry(EntryId id) const;
+
+  const char* GetCacheEntryKey(EntryId id) const
+  {
+    return this->Layout->Pool->Get(this->Layout->Keys[id]);
+  }
+
+  const char* GetCacheEntryValue(EntryId id) const
+  {
+    return this->Layout->Pool->Get(this->States[id].Value);
+  }
+
+  const char* GetCacheEntryCanonicalValue(EntryId id) const
+  {
+    return this->Layout->Pool->Get(this->States[id].Canonical);
+  }
+
+  // Whether the value is on, as by cmSystemTools::IsOn(); meaningful
+  // for BOOL entries, whose canonical value is ON for such values and
+  // OFF for all others.
+  bool GetCacheEntryValueAsBool(EntryId id) const
+  {
+    return this->States[id].Canonical == this->Layout->On;
+  }
+
+  cmStateEnums::CacheEntryType GetCacheEntryType(EntryId id) const
+  {
+    return this->Layout->Types[id];
+  }
+
+  // The items of the STRINGS property of the entry.
+  std::size_t GetCacheEntryNumberOfStrings(EntryId id) const
+  {
+    return this->Layout->StringsItems[id].size();
+  }
+  const char* GetCacheEntryString(EntryId id, std::size_t index) const
+  {
+    return this->Layout->Pool->Get(this->Layout->StringsItems[id][index]);
+  }
+
+  bool GetCacheEntryFlag(EntryId id, CacheEntryFlag flag) const
+  {
+    return (this->States[id].Flags & flag) != 0;
+  }
+
+  const char* GetCacheEntryProperty(
+    EntryId id, cmStateEnums::CacheEntryProperty property) const;
+  const char* GetCacheEntryProperty(
+    EntryId id, std::string const& propertyName) const;
+
+  void SetCacheEntryProperty(
+    EntryId id, cmStateEnums::CacheEntryProperty property,
+    std::string const& value);
+  void SetCacheEntryProperty(
+    EntryId id, std::string const& propertyName, std::string const& value);
+
+  void SetCacheEntryFlag(EntryId id, CacheEntryFlag flag, bool value);
+
+  void SetCacheEntryValue(EntryId id, std::string const& value);
+
+  // PATH and FILEPATH entries whose value is the path or lies below it.
+  std::vector<EntryId> FindCacheEntriesUnderPath(
+    std::string const& path) const;
+
+  // Entries by the trigrams of the words of their key, value and help
+  // string.
+  cmTrigramIndex const& GetWordIndex() const { return *this->Layout->Words; }
 
-  std::vector<std::string> GetCacheEntryKeys() const;
+  // Types of all entries, indexed by EntryId.
+  std::vector<cmStateEnums::CacheEntryType> const& GetTypeColumn() const
+  {
+    return this->Layout->Types;
+  }
+
+  // Add a hidden entry and return its index; adding entries in key
+  // order keeps this cheap.
+  std::size_t AddHiddenCacheEntry(
+    std::string const& key, cmStateEnums::CacheEntryType type,
+    std::string const& value);
+  std::size_t GetNumberOfHiddenCacheEntries() const
+  {
+    return this->Layout->Hidden.size();
+  }
+  // Returns GetNumberOfHiddenCacheEntries() if there is none.
+  std::size_t FindHiddenCacheEntry(std::string const& key) const;
+  const char* GetHiddenCacheEntryKey(std::size_t index) const
+  {
+    return this->Layout->Pool->Get(this->Layout->Hidden[index].Key);
+  }
+  CacheEntry GetHiddenCacheEntry(std::size_t index) const;
+  const char* GetHiddenCacheEntryProperty(
+    std::size_t index, std::string const& propertyName) const;
+  void SetHiddenCacheEntryProperty(
+    std::size_t index, std::string const& propertyName,
+    std::string const& value);
+
+  // The pool holding the strings of the current entries.  Holding on
+  // to it keeps returned strings valid after the cache is cleared.
+  std::shared_ptr<cmStringPool const> GetStringPool() const
+  {
+    return this->Layout->Pool;
+  }
 
   const char* GetCacheEntryValue(std::string const& key) const;
 
@@ -45,7 +231,127 @@ public:
   void SetCacheEntryValue(std::string const& key, std::string const& value);
 
 private:
-  std::map<std::string, CacheEntry> Cache;
+  struct EntryState
+  {
+    cmStringPool::Handle Value;
+    cmStringPool::Handle Canonical;
+    cmPathTrie::NodeId Path; // InvalidNode unless a PATH or FILEPATH
+    unsigned char Flags;
+  };
+
+  // Property bags are singly linked lists of items, all in one array.
+  // Names are interned, so they are compared by handle.
+  struct BagItem
+  {
+    cmStringPool::Handle Name;
+    cmStringPool::Handle Value;
+    std::uint32_t Next;
+  };
+
+  struct HiddenEntry
+  {
+    cmStringPool::Handle Key;
+    cmStringPool::Handle Value;
+    std::uint32_t Bag;
+    cmStateEnums::CacheEntryType Type;
+  };
+
+  // The part of the cache that edits do not change.
+  struct CacheLayout
+  {
+    std::shared_ptr<cmStringPool> Pool;
+    std::shared_ptr<cmPathTrie> Paths;
+    std::shared_ptr<cmTrigramIndex> Words;
+
+    std::vector<cmStringPool::Handle> Keys;
+    std::vector<cmStateEnums::CacheEntryType> Types;
+    std::vector<cmStringPool::Handle> HelpStrings;
+    std::vector<cmStringPool::Handle> Strings;
+    std::vector<std::vector<cmStringPool::Handle>> StringsItems;
+
+    // Canonical value of BOOL entries that are on.
+    cmStringPool::Handle On;
+
+    std::vector<std::uint32_t> Bags; // first item of each entry
+    std::vector<BagItem> BagItems;
+
+    std::vector<HiddenEntry> Hidden; // sorted by key
+
+    // Open addressing with linear probing; the size is a power of two
+    // and at least twice the number of entries.
+    std::vector<EntryId> Index;
+  };
+
+public:
+  /** \class Snapshot
+   * \brief The cache at one point in time.
+   */
+  class Snapshot
+  {
+  public:
+    std::size_t GetNumberOfCacheEntries() const
+    {
+      return this->Layout->Keys.size();
+    }
+    EntryId FindCacheEntry(std::string const& key) const
+    {
+      return FindInIndex(*this->Layout, key.data(), key.size());
+    }
+    const char* GetCacheEntryKey(EntryId id) const
+    {
+      return this->Layout->Pool->Get(this->Layout->Keys[id]);
+    }
+    const char* GetCacheEntryValue(EntryId id) const
+    {
+      return this->Layout->Pool->Get(this->States[id].Value);
+    }
+    const char* GetCacheEntryCanonicalValue(EntryId id) const
+    {
+      return this->Layout->Pool->Get(this->States[id].Canonical);
+    }
+    cmStateEnums::CacheEntryType GetCacheEntryType(EntryId id) const
+    {
+      return this->Layout->Types[id];
+    }
+
+  private:
+    friend class cmState;
+    std::shared_ptr<CacheLayout const> Layout;
+    cmPersistentVector<EntryState> States;
+  };
+
+  Snapshot TakeSnapshot() const;
+  void RestoreSnapshot(Snapshot const& snapshot);
+
+  // Add the entries of the snapshot that are missing here, flagged as
+  // removed, copying the layout at most once.  They are left out of
+  // the word and path indexes, as removed entries are never shown.
+  void AddRemovedCacheEntries(Snapshot const& snapshot);
+
+  // Whether the snapshot has the same entries with the same ids.
+  bool HasSameLayout(Snapshot const& snapshot) const
+  {
+    return this->Layout == snapshot.Layout;
+  }
+
+private:
+  // Layouts may be shared with snapshots, copy before modifying.
+  CacheLayout& MutableLayout();
+  void Rehash(CacheLayout& layout, std::size_t size);
+  static EntryId FindInIndex(CacheLayout const& layout, const char* key,
+                             std::size_t length);
+  void InternValue(EntryState& state, cmStateEnums::CacheEntryType type,
+                   std::string const& value);
+
+  const char* GetBagProperty(std::uint32_t bag,
+                             std::string const& name) const;
+  void SetBagProperty(std::uint32_t& bag, std::string const& name,
+                      std::string const& value);
+
+  std::shared_ptr<CacheLayout> Layout = NewLayout();
+  cmPersistentVector<EntryState> States;
+
+  static std::shared_ptr<CacheLayout> NewLayout();
 };
 
 #endif
@@ -16,6 +16,19 @@ enum CacheEntryType
   UNINITIALIZED
 };
 
+// Cache entry properties that cmState keeps in dedicated storage.  All
+// other properties are kept by name in a per-entry property bag.
+enum CacheEntryProperty
+{
+  ADVANCED = 0,
+  HELPSTRING,
+  MODIFIED,
+  STRINGS,
+  TYPE,
+  VALUE,
+  OTHER_PROPERTY
+};
+
 } // namespace cmStateEnums
 
 #endif
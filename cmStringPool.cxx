@@ -0,0 +1,149 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmStringPool.h"
+
+#include <cstring>
+
+namespace {
+
+std::size_t const block_size = 64 * 1024;
+
+} // namespace
+
+cmStringPool::Handle const cmStringPool::Empty = 0;
+cmStringPool::Handle const cmStringPool::InvalidHandle =
+  static_cast<Handle>(-1);
+
+cmStringPool::cmStringPool()
+{
+  this->Reset();
+}
+
+cmStringPool::~cmStringPool()
+{
+  for (char* block : this->Blocks) {
+    delete[] block;
+  }
+  for (char* block : this->LargeBlocks) {
+    delete[] block;
+  }
+}
+
+// FNV-1a
+std::uint32_t cmStringPool::Hash(const char* str, std::size_t length)
+{
+  std::uint32_t hash = 2166136261u;
+  for (std::size_t i = 0; i < length; ++i) {
+    hash ^= static_cast<unsigned char>(str[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+void cmStringPool::Reset()
+{
+  // Keep the first block; all regular blocks have the same size.
+  if (this->Blocks.empty()) {
+    this->Blocks.push_back(new char[block_size]);
+  }
+  for (std::size_t i = 1; i < this->Blocks.size(); ++i) {
+    delete[] this->Blocks[i];
+  }
+  this->Blocks.resize(1);
+  for (char* block : this->LargeBlocks) {
+    delete[] block;
+  }
+  this->LargeBlocks.clear();
+  this->Cursor = this->Blocks[0];
+  this->Available = block_size;
+  this->AllocatedBytes = block_size;
+
+  this->Strings.clear();
+  this->Index.clear();
+  this->Intern("", 0);
+}
+
+char* cmStringPool::Allocate(std::size_t size)
+{
+  if (size > this->Available) {
+    if (size > block_size / 4) {
+      // Large strings get a block of their own, so that the rest of the
+      // current block is not wasted.
+      char* block = new char[size];
+      this->LargeBlocks.push_back(block);
+      this->AllocatedBytes += size;
+      return block;
+    }
+    this->Blocks.push_back(new char[block_size]);
+    this->Cursor = this->Blocks.back();
+    this->Available = block_size;
+    this->AllocatedBytes += block_size;
+  }
+  char* result = this->Cursor;
+  this->Cursor += size;
+  this->Available -= size;
+  return result;
+}
+
+void cmStringPool::Rehash(std::size_t size)
+{
+  this->Index.assign(size, InvalidHandle);
+  std::size_t const mask = size - 1;
+  for (Handle handle = 0; handle < this->Strings.size(); ++handle) {
+    std::size_t slot = this->Strings[handle].Hash & mask;
+    while (this->Index[slot] != InvalidHandle) {
+      slot = (slot + 1) & mask;
+    }
+    this->Index[slot] = handle;
+  }
+}
+
+std::size_t cmStringPool::FindSlot(const char* str, std::size_t length,
+                                   std::uint32_t hash) const
+{
+  std::size_t const mask = this->Index.size() - 1;
+  for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    Handle const handle = this->Index[slot];
+    if (handle == InvalidHandle) {
+      return slot;
+    }
+    String const& candidate = this->Strings[handle];
+    if (candidate.Hash == hash && candidate.Length == length &&
+        std::memcmp(candidate.Data, str, length) == 0) {
+      return slot;
+    }
+  }
+}
+
+cmStringPool::Handle cmStringPool::Find(const char* str,
+                                        std::size_t length) const
+{
+  if (this->Index.empty()) {
+    return InvalidHandle;
+  }
+  return this->Index[this->FindSlot(str, length, Hash(str, length))];
+}
+
+cmStringPool::Handle cmStringPool::Intern(const char* str, std::size_t length)
+{
+  if (2 * (this->Strings.size() + 1) > this->Index.size()) {
+    this->Rehash(this->Index.empty() ? 256 : 2 * this->Index.size());
+  }
+
+  std::uint32_t const hash = Hash(str, length);
+  std::size_t const slot = this->FindSlot(str, length, hash);
+  if (this->Index[slot] != InvalidHandle) {
+    return this->Index[slot];
+  }
+
+  char* data = this->Allocate(length + 1);
+  std::memcpy(data, str, length);
+  data[length] = '\0';
+
+  Handle const handle = static_cast<Handle>(this->Strings.size());
+  String const string = { data, static_cast<std::uint32_t>(length), hash };
+  this->Strings.push_back(string);
+  this->Index[slot] = handle;
+  return handle;
+}
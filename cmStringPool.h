@@ -0,0 +1,89 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmStringPool_h
+#define cmStringPool_h
+
+#include "cmConfigure.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** \class cmStringPool
+ * \brief Arena of interned, null-terminated strings.
+ *
+ * Every distinct string is copied into the arena once and identified by
+ * a handle.  Strings are never freed individually; Reset() releases all
+ * of them at once and keeps the first block of the arena for reuse.
+ * Pointers returned by Get() stay valid until then.
+ */
+class cmStringPool
+{
+  CM_DISABLE_COPY(cmStringPool)
+
+public:
+  typedef std::uint32_t Handle;
+
+  // The empty string is always interned with this handle.
+  static Handle const Empty;
+  static Handle const InvalidHandle;
+
+  cmStringPool();
+  ~cmStringPool();
+
+  Handle Intern(const char* str, std::size_t length);
+  Handle Intern(std::string const& str)
+  {
+    return this->Intern(str.data(), str.size());
+  }
+
+  // Find the handle of a string that was interned before.
+  Handle Find(const char* str, std::size_t length) const;
+
+  const char* Get(Handle handle) const
+  {
+    return this->Strings[handle].Data;
+  }
+  std::size_t GetLength(Handle handle) const
+  {
+    return this->Strings[handle].Length;
+  }
+  std::uint32_t GetHash(Handle handle) const
+  {
+    return this->Strings[handle].Hash;
+  }
+
+  std::size_t GetNumberOfStrings() const { return this->Strings.size(); }
+  std::size_t GetAllocatedBytes() const { return this->AllocatedBytes; }
+
+  void Reset();
+
+  static std::uint32_t Hash(const char* str, std::size_t length);
+
+private:
+  struct String
+  {
+    const char* Data;
+    std::uint32_t Length;
+    std::uint32_t Hash;
+  };
+
+  char* Allocate(std::size_t size);
+  void Rehash(std::size_t size);
+  std::size_t FindSlot(const char* str, std::size_t length,
+                       std::uint32_t hash) const;
+
+  std::vector<String> Strings;
+  std::vector<Handle> Index;
+
+  // Blocks of the regular size, the last one being filled, and blocks
+  // of a single large string
+  std::vector<char*> Blocks;
+  std::vector<char*> LargeBlocks;
+  char* Cursor = nullptr;
+  std::size_t Available = 0;
+  std::size_t AllocatedBytes = 0;
+};
+
+#endif
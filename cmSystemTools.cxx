@@ -4,6 +4,8 @@
 #include "cmSystemTools.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 
@@ -17,7 +19,26 @@ cmSystemTools::MessageCallback s_MessageCallback = nullptr;
 void* s_MessageCallbackClientData = nullptr;
 
 const char* const on_values[]{"ON", "1", "YES", "TRUE", "Y"};
-const char* const off_values[]{"OFF", "0", "No", "FALSE", "N", "IGNORE"};
+const char* const off_values[]{"OFF", "0", "NO", "FALSE", "N", "IGNORE"};
+
+// Longest of the values above.
+std::size_t const max_bool_length = 6;
+
+// Case-insensitive lookup of the string in the values.
+template <std::size_t N>
+bool IsOneOf(std::string const& str, const char* const (&values)[N])
+{
+  if (str.empty() || str.size() > max_bool_length) {
+    return false;
+  }
+  char upper[max_bool_length + 1];
+  std::transform(str.begin(), str.end(), upper, [](char c) {
+    return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  });
+  upper[str.size()] = '\0';
+  return std::any_of(std::begin(values), std::end(values),
+                     [&](const char* val) { return !strcmp(val, upper); });
+}
 
 std::string cmSystemToolsCMakeCursesCommand;
 
@@ -25,16 +46,21 @@ std::string cmSystemToolsCMakeCursesCommand;
 
 bool cmSystemTools::IsOn(std::string const& str)
 {
-  return std::any_of(
-    std::begin(on_values), std::end(on_values),
-    [&](const char* val) { return val == str; });
+  return IsOneOf(str, on_values);
 }
 
 bool cmSystemTools::IsOff(std::string const& str)
 {
-  return std::any_of(
-    std::begin(off_values), std::end(off_values),
-    [&](const char* val) { return val == str; });
+  static std::string const notfound = "NOTFOUND";
+  if (str.empty() || str == notfound) {
+    return true;
+  }
+  if (str.size() > notfound.size() &&
+      str.compare(str.size() - notfound.size() - 1, std::string::npos,
+                  "-NOTFOUND") == 0) {
+    return true;
+  }
+  return IsOneOf(str, off_values);
 }
 
 void cmSystemTools::SetMessageCallback(
@@ -11,6 +11,7 @@
 class cmSystemTools : public cmsys::SystemTools
 {
 public:
+  // Both ignore case.  Empty and NOTFOUND values are off.
   static bool IsOn(std::string const& val);
   static bool IsOff(std::string const& val);
 
@@ -0,0 +1,122 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmTrace.h"
+
+#include <utility>
+#include <vector>
+
+#include <json/value.h>
+#include <json/writer.h>
+#include <uv.h>
+
+#include "cmsys/FStream.hxx"
+
+namespace {
+
+struct Span
+{
+  std::string Name;
+  std::uint64_t Begin;
+  std::uint64_t End;
+  const char* ArgName;
+  int ArgValue;
+};
+
+std::string s_TraceFile;
+std::uint64_t s_TraceStart = 0;
+std::vector<Span> s_Spans;
+
+Json::Value to_us(std::uint64_t ns)
+{
+  return static_cast<double>(ns) / 1e3;
+}
+
+} // namespace
+
+bool cmTrace::Enabled = false;
+
+void cmTrace::Start(std::string const& file)
+{
+  s_TraceFile = file;
+  s_TraceStart = uv_hrtime();
+  s_Spans.clear();
+  cmTrace::Enabled = true;
+}
+
+bool cmTrace::Stop()
+{
+  if (!cmTrace::Enabled) {
+    return true;
+  }
+  cmTrace::Enabled = false;
+
+  Json::Value events = Json::arrayValue;
+  for (Span const& span : s_Spans) {
+    Json::Value event = Json::objectValue;
+    event["name"] = span.Name;
+    event["cat"] = "nccmake";
+    event["ph"] = "X";
+    event["ts"] = to_us(span.Begin - s_TraceStart);
+    event["dur"] = to_us(span.End - span.Begin);
+    event["pid"] = 1;
+    event["tid"] = 1;
+    if (span.ArgName) {
+      event["args"][span.ArgName] = span.ArgValue;
+    }
+    events.append(event);
+  }
+  s_Spans.clear();
+
+  Json::Value root = Json::objectValue;
+  root["traceEvents"] = events;
+  root["displayTimeUnit"] = "ms";
+
+  cmsys::ofstream fout(s_TraceFile.c_str());
+  if (!fout) {
+    return false;
+  }
+  Json::FastWriter writer;
+  fout << writer.write(root);
+  return static_cast<bool>(fout);
+}
+
+void cmTrace::AddSpan(
+  std::string name, std::uint64_t begin, std::uint64_t end,
+  const char* argName, int argValue)
+{
+  s_Spans.push_back(Span{ std::move(name), begin, end, argName, argValue });
+}
+
+cmTraceScope::cmTraceScope(const char* name, const char* detail)
+  : Name(name)
+  , Detail(detail)
+{
+  if (cmTrace::IsEnabled()) {
+    this->Begin = uv_hrtime();
+  }
+}
+
+cmTraceScope::cmTraceScope(const char* name, const char* argName, int argValue)
+  : Name(name)
+  , ArgName(argName)
+  , ArgValue(argValue)
+{
+  if (cmTrace::IsEnabled()) {
+    this->Begin = uv_hrtime();
+  }
+}
+
+cmTraceScope::~cmTraceScope()
+{
+  if (!cmTrace::IsEnabled() || this->Begin == 0) {
+    return;
+  }
+  std::string name = this->Name;
+  if (this->Detail) {
+    name += ' ';
+    name += this->Detail;
+  }
+  cmTrace::AddSpan(
+    std::move(name), this->Begin, uv_hrtime(), this->ArgName, this->ArgValue);
+}
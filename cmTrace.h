@@ -0,0 +1,53 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmTrace_h
+#define cmTrace_h
+
+#include <cstdint>
+#include <string>
+
+/** \class cmTrace
+ * \brief Record a timeline in the Chrome trace-event format.
+ *
+ * Spans are kept in memory while tracing and written as one JSON
+ * document by Stop(), which Perfetto and chrome://tracing can load.
+ * When tracing is off a span costs a single flag test.
+ */
+class cmTrace
+{
+public:
+  static void Start(std::string const& file);
+  static bool Stop();
+
+  static bool IsEnabled() { return cmTrace::Enabled; }
+
+  static void AddSpan(
+    std::string name, std::uint64_t begin, std::uint64_t end,
+    const char* argName, int argValue);
+
+private:
+  static bool Enabled;
+};
+
+/** \class cmTraceScope
+ * \brief A span that lasts until the end of the enclosing scope.
+ */
+class cmTraceScope
+{
+public:
+  explicit cmTraceScope(const char* name, const char* detail = nullptr);
+  cmTraceScope(const char* name, const char* argName, int argValue);
+  ~cmTraceScope();
+
+  cmTraceScope(cmTraceScope const&) = delete;
+  cmTraceScope& operator=(cmTraceScope const&) = delete;
+
+private:
+  const char* Name;
+  const char* Detail = nullptr;
+  const char* ArgName = nullptr;
+  int ArgValue = 0;
+  std::uint64_t Begin = 0;
+};
+
+#endif
@@ -0,0 +1,50 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmTrigramIndex.h"
+
+#include <algorithm>
+
+cmTrigramIndex::cmTrigramIndex()
+  : Ids(NumberOfTrigrams)
+{
+}
+
+int cmTrigramIndex::Fold(char c)
+{
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'z') {
+    return 10 + (c - 'a');
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return 10 + (c - 'A');
+  }
+  return -1;
+}
+
+void cmTrigramIndex::Add(Id id, const char* text)
+{
+  if (!text) {
+    return;
+  }
+  // Length of the word that ends at the current character.
+  std::size_t word = 0;
+  for (const char* c = text; *c; ++c) {
+    word = Fold(*c) < 0 ? 0 : word + 1;
+    if (word < 3) {
+      continue;
+    }
+    std::vector<Id>& ids = this->Ids[Encode(c - 2)];
+    // Texts are mostly added in the order of their ids.
+    if (ids.empty() || ids.back() < id) {
+      ids.push_back(id);
+    } else if (ids.back() != id) {
+      std::vector<Id>::iterator it =
+        std::lower_bound(ids.begin(), ids.end(), id);
+      if (*it != id) {
+        ids.insert(it, id);
+      }
+    }
+  }
+}
@@ -0,0 +1,61 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#ifndef cmTrigramIndex_h
+#define cmTrigramIndex_h
+
+#include "cmConfigure.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** \class cmTrigramIndex
+ * \brief Ids of texts by the trigrams of their words.
+ *
+ * Words are runs of ASCII letters and digits and are folded to lower
+ * case, so there are only 36^3 trigrams and the lists of ids are
+ * addressed by the trigram directly.  Lists are kept sorted.
+ *
+ * Ids are never removed: a text that changes adds the trigrams of its
+ * new version.  The index is therefore a superset, suitable to find
+ * candidates that are then checked against the actual text.
+ */
+class cmTrigramIndex
+{
+  CM_DISABLE_COPY(cmTrigramIndex)
+
+public:
+  typedef std::uint32_t Id;
+  typedef std::uint32_t Trigram;
+
+  enum
+  {
+    NumberOfTrigrams = 36 * 36 * 36
+  };
+
+  cmTrigramIndex();
+
+  // Add the id to the lists of the trigrams of the words of the text.
+  void Add(Id id, const char* text);
+
+  std::vector<Id> const& Find(Trigram trigram) const
+  {
+    return this->Ids[trigram];
+  }
+
+  // The digit or lower-case letter of an ASCII letter or digit, as a
+  // number below 36, or -1.
+  static int Fold(char c);
+
+  // The trigram of three characters that Fold() accepts.
+  static Trigram Encode(const char* word)
+  {
+    return static_cast<Trigram>((Fold(word[0]) * 36 + Fold(word[1])) * 36 +
+                                Fold(word[2]));
+  }
+
+private:
+  std::vector<std::vector<Id>> Ids;
+};
+
+#endif
@@ -3,15 +3,19 @@
 
 #include "cmake.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <iostream>
 #include <json/reader.h>
 #include <json/writer.h>
 #include <map>
+#include <utility>
+#include <vector>
 
 #include "cmState.h"
 #include "cmStateTypes.h"
 #include "cmSystemTools.h"
+#include "cmTrace.h"
 
 namespace {
 
@@ -37,6 +41,18 @@ void on_read(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf)
   delete[] buf->base;
 }
 
+// A request written without waiting for the write to complete.
+struct WriteRequest
+{
+  uv_write_t Request;
+  std::string Data;
+};
+
+void on_write(uv_write_t* req, int /*status*/)
+{
+  delete static_cast<WriteRequest*>(req->data);
+}
+
 void on_process_close(uv_handle_t* handle)
 {
   delete reinterpret_cast<uv_process_t*>(handle);
@@ -54,12 +70,30 @@ void on_exit(uv_process_t* req, int64_t exit_status, int term_signal)
 
 } // namespace
 
+struct cmake::CacheIngest
+{
+  uv_work_t Request;
+  cmake* CMake;
+  std::string Input;
+  std::uint64_t ArrivalTime;
+
+  // Written by the worker, read by the loop thread once it is done.
+  Json::Value Value;
+  bool Parsed = false;
+  std::unique_ptr<cmState> State; // only for the reply to "cache"
+  std::uint64_t ParseStart = 0;
+  std::uint64_t ParseEnd = 0;
+  std::uint64_t IngestEnd = 0;
+};
+
 cmake::cmake(Role role)
 {
   if (role != RoleProject) {
     return;
   }
 
+  cmTraceScope scope("server spawn");
+
   this->State.reset(new cmState);
 
   uv_loop_t* loop = uv_default_loop();
@@ -106,6 +140,10 @@ cmake::cmake(Role role)
 
 cmake::~cmake()
 {
+  // The worker of an ingestion must not outlive the loop.
+  while (this->Ingest) {
+    uv_run(uv_default_loop(), UV_RUN_ONCE);
+  }
   uv_loop_close(uv_default_loop());
 }
 
@@ -300,23 +338,26 @@ void cmake::SetDirectoriesFromFile(std::string const& arg)
   this->SetHomeOutputDirectory(cwd);
 }
 
-int cmake::Configure()
+int cmake::Configure(bool waitForCache)
 {
-  for (auto const& entry : this->State->GetCache()) {
-    if (entry.second.IsRemoved) {
-      this->CacheArguments.append("-U" + entry.first);
+  cmState const& state = *this->State;
+  for (cmState::EntryId id = 0; id < state.GetNumberOfCacheEntries(); ++id) {
+    if (state.GetCacheEntryFlag(id, cmState::FlagRemoved)) {
+      this->CacheArguments.append(std::string("-U") +
+                                  state.GetCacheEntryKey(id));
     }
-    if (entry.second.IsModified) {
-      this->CacheArguments.append(
-        "-D" + entry.first + "=" + entry.second.Value);
+    if (state.GetCacheEntryFlag(id, cmState::FlagModified)) {
+      this->CacheArguments.append(std::string("-D") +
+                                  state.GetCacheEntryKey(id) + "=" +
+                                  state.GetCacheEntryValue(id));
     }
   }
 
   Json::Value data = Json::objectValue;
   data["cacheArguments"] = this->CacheArguments;
   this->SendRequest("configure", data);
-  this->SendRequest("cache");
   this->CacheArguments.clear();
+  this->SendRequest("cache", Json::objectValue, waitForCache);
   return 0;
 }
 
@@ -328,7 +369,9 @@ int cmake::Generate()
 
 void cmake::ReadData(const char* data, ssize_t len)
 {
+  this->ArrivalTime = uv_hrtime();
   this->RawReadBuffer.append(data, len);
+  this->Metrics.Get(this->ExpectedReply).BytesReceived += len;
 
   for (;;) {
     auto needle = this->RawReadBuffer.find('\n');
@@ -352,7 +395,7 @@ void cmake::ReadData(const char* data, ssize_t len)
     }
 
     if (line == END_MAGIC) {
-      this->HandleResponse(this->RequestBuffer);
+      this->DispatchResponse(std::move(this->RequestBuffer));
       this->RequestBuffer.clear();
     } else {
       this->RequestBuffer += line;
@@ -361,15 +404,39 @@ void cmake::ReadData(const char* data, ssize_t len)
   }
 }
 
+void cmake::DispatchResponse(std::string response)
+{
+  if (this->Ingest) {
+    // Keep the order in which responses arrived, and when.
+    PendingResponse pending = { std::move(response), this->ArrivalTime };
+    this->PendingResponses.push_back(std::move(pending));
+  } else if (this->ExpectedReply == "cache") {
+    this->StartIngest(std::move(response));
+  } else {
+    this->HandleResponse(response);
+  }
+}
+
 void cmake::HandleResponse(std::string const& input)
 {
   Json::Value value;
   Json::Reader reader;
-  if (!reader.parse(input, value)) {
+  std::uint64_t const parseStart = uv_hrtime();
+  bool parsed;
+  {
+    cmTraceScope scope("JSON parse");
+    parsed = reader.parse(input, value);
+  }
+  this->Metrics.Get(this->ExpectedReply).Parse.Add(uv_hrtime() - parseStart);
+  if (!parsed) {
     // this->WriteParseError("Failed to parse JSON input.");
     return;
   }
+  this->HandleValue(value);
+}
 
+void cmake::HandleValue(Json::Value const& value)
+{
   std::string const type = value["type"].asString();
   if (type == "hello") {
     this->HandleHello(value);
@@ -408,18 +475,95 @@ void cmake::HandleHello(Json::Value const&  /*data*/)
   uv_stop(uv_default_loop());
 }
 
-void cmake::HandleReply(std::string const& type, Json::Value const& data)
+void cmake::HandleReply(std::string const& type, Json::Value const& /*data*/)
 {
   uv_stop(uv_default_loop());
+  this->Profiler.Finish(this->ArrivalTime);
+  cmSessionMetrics::Request& metrics = this->Metrics.Get(type);
+  metrics.Latency.Add(this->ArrivalTime - this->RequestTime);
   if (type == "cache") {
-    this->ReadCache(data["cache"]);
+    this->FinishCacheLoad();
+  }
+}
+
+// Responses to the cache request can be several megabytes.  Parse them
+// and build the new state on the thread pool, so the loop keeps
+// running meanwhile; the current state is not touched until the new
+// one is complete.
+void cmake::StartIngest(std::string response)
+{
+  this->Ingest.reset(new CacheIngest);
+  this->Ingest->Request.data = this->Ingest.get();
+  this->Ingest->CMake = this;
+  this->Ingest->Input = std::move(response);
+  this->Ingest->ArrivalTime = this->ArrivalTime;
+  uv_queue_work(uv_default_loop(), &this->Ingest->Request, IngestWork,
+                IngestDone);
+}
+
+// Runs on a worker thread; must not touch anything but the ingest.
+void cmake::IngestWork(uv_work_t* req)
+{
+  CacheIngest& ingest = *static_cast<CacheIngest*>(req->data);
+  Json::Reader reader;
+  ingest.ParseStart = uv_hrtime();
+  ingest.Parsed = reader.parse(ingest.Input, ingest.Value);
+  ingest.ParseEnd = uv_hrtime();
+  ingest.Input.clear();
+  if (ingest.Parsed && ingest.Value["type"].asString() == "reply" &&
+      ingest.Value["inReplyTo"].asString() == "cache") {
+    ingest.State.reset(new cmState);
+    ReadCache(*ingest.State, ingest.Value["cache"]);
+  }
+  ingest.IngestEnd = uv_hrtime();
+}
+
+void cmake::IngestDone(uv_work_t* req, int /*status*/)
+{
+  static_cast<CacheIngest*>(req->data)->CMake->FinishIngest();
+}
+
+void cmake::FinishIngest()
+{
+  std::unique_ptr<CacheIngest> ingest = std::move(this->Ingest);
+  if (cmTrace::IsEnabled()) {
+    cmTrace::AddSpan("JSON parse", ingest->ParseStart, ingest->ParseEnd,
+                     nullptr, 0);
+    if (ingest->State) {
+      cmTrace::AddSpan("ReadCache", ingest->ParseEnd, ingest->IngestEnd,
+                       nullptr, 0);
+    }
+  }
+  this->ArrivalTime = ingest->ArrivalTime;
+  cmSessionMetrics::Request& metrics = this->Metrics.Get("cache");
+  metrics.Parse.Add(ingest->ParseEnd - ingest->ParseStart);
+
+  if (ingest->State) {
+    // Publish the new cache in one step.  Snapshots of the old one,
+    // like the undo history, stay valid.
+    this->State->RestoreSnapshot(ingest->State->TakeSnapshot());
+    metrics.Ingest.Add(ingest->IngestEnd - ingest->ParseEnd);
+  }
+  if (ingest->Parsed) {
+    this->HandleValue(ingest->Value);
+  }
+
+  while (!this->Ingest && !this->PendingResponses.empty()) {
+    PendingResponse pending = std::move(this->PendingResponses.front());
+    this->PendingResponses.pop_front();
+    this->ArrivalTime = pending.ArrivalTime;
+    this->DispatchResponse(std::move(pending.Text));
   }
 }
 
 void cmake::HandleError(Json::Value const& data)
 {
+  this->Profiler.Finish(this->ArrivalTime);
   std::string const error_message = data["errorMessage"].asString();
   cmSystemTools::Error("Server Error: ", error_message.c_str());
+  if (data["inReplyTo"].asString() == "cache") {
+    this->FinishCacheLoad();
+  }
 }
 
 void cmake::HandleMessage(Json::Value const& data)
@@ -427,6 +571,7 @@ void cmake::HandleMessage(Json::Value const& data)
   std::string const title = data["title"].asString();
   std::string const message = data["message"].asString();
   this->ProgressMessage = message;
+  this->Profiler.AddMessage(this->ArrivalTime, message);
   if (this->ProgressCallback) {
     this->ProgressCallback(
       this->ProgressMessage.c_str(), this->Progress, this->ProgressUserData);
@@ -439,6 +584,7 @@ void cmake::HandleProgress(Json::Value const& data)
   int const maximum = data["progressMaximum"].asInt();
   int const minimum = data["progressMinimum"].asInt();
   this->Progress = float(current) / float(maximum);
+  this->Profiler.AddProgress(this->ArrivalTime, this->Progress);
   if (this->ProgressCallback) {
     this->ProgressCallback(
       this->ProgressMessage.c_str(), this->Progress, this->ProgressUserData);
@@ -449,63 +595,103 @@ void cmake::HandleSignal(Json::Value const&  /*data*/)
 {
 }
 
-void cmake::SendRequest(std::string const& type, Json::Value extra)
+void cmake::FinishCacheLoad()
 {
+  if (!this->CacheLoading) {
+    return;
+  }
+  this->CacheLoading = false;
+  if (this->CacheCallback) {
+    this->CacheCallback(this->CacheUserData);
+  }
+}
+
+void cmake::SendRequest(std::string const& type, Json::Value extra,
+                        bool wait)
+{
+  cmTraceScope scope("request", type.c_str());
+
   this->ExpectedReply = type;
+  this->RequestTime = uv_hrtime();
+  if (type == "configure" || type == "compute") {
+    this->Profiler.Start(type, this->RequestTime);
+  }
   extra["type"] = type;
 
-  Json::FastWriter writer;
-  std::string const raw =
-    "\n" START_MAGIC "\n" + writer.write(extra) + END_MAGIC "\n";
+  if (type == "cache") {
+    this->CacheLoading = true;
+  }
 
-  uv_write_t req;
-  uv_buf_t const buf = uv_buf_init(const_cast<char*>(raw.data()), raw.size());
+  // The request may still be written after this returns; it frees
+  // itself when done.
+  Json::FastWriter writer;
+  WriteRequest* req = new WriteRequest;
+  req->Request.data = req;
+  req->Data = "\n" START_MAGIC "\n" + writer.write(extra) + END_MAGIC "\n";
+  uv_buf_t const buf =
+    uv_buf_init(const_cast<char*>(req->Data.data()), req->Data.size());
   uv_write(
-    &req, reinterpret_cast<uv_stream_t*>(&this->ServerInput), &buf, 1,
-    nullptr);
+    &req->Request, reinterpret_cast<uv_stream_t*>(&this->ServerInput), &buf,
+    1, on_write);
 
   uv_read_start(
     reinterpret_cast<uv_stream_t*>(&this->ServerOutput), on_alloc, on_read);
 
-  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
-}
-
-static cmStateEnums::CacheEntryType parse_type(std::string const& str)
-{
-  if (str == "BOOL") {
-    return cmStateEnums::BOOL;
-  }
-  if (str == "PATH") {
-    return cmStateEnums::PATH;
-  }
-  if (str == "FILEPATH") {
-    return cmStateEnums::FILEPATH;
-  }
-  if (str == "STRING") {
-    return cmStateEnums::STRING;
-  }
-  if (str == "INTERNAL") {
-    return cmStateEnums::INTERNAL;
-  }
-  if (str == "STATIC") {
-    return cmStateEnums::STATIC;
+  if (wait) {
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
   }
-  return cmStateEnums::UNINITIALIZED;
 }
 
-void cmake::ReadCache(Json::Value const& json)
+void cmake::ReadCache(cmState& state, Json::Value const& json)
 {
-  auto& cache = this->State->GetCache();
-  cache.clear();
-
-  for (Json::Value elem : json) {
-    std::string const key = elem["key"].asString();
-    auto& cache_entry = cache[key];
-    cache_entry.Type = parse_type(elem["type"].asString());
-    cache_entry.Value = elem["value"].asString();
-    cache_entry.Strings = elem["properties"]["STRINGS"].asString();
-    cache_entry.HelpString = elem["properties"]["HELPSTRING"].asString();
-    cache_entry.IsAdvanced =
-      cmSystemTools::IsOn(elem["properties"]["ADVANCED"].asString());
+  // The server reports entries in no particular order; add them sorted
+  // by key so that ids follow the order in which they are listed.  The
+  // keys are read once, not on every comparison.
+  typedef std::pair<std::string, Json::Value const*> KeyedElement;
+  std::vector<KeyedElement> elems;
+  elems.reserve(json.size());
+  for (Json::Value const& elem : json) {
+    elems.emplace_back(elem["key"].asString(), &elem);
+  }
+  std::sort(elems.begin(), elems.end(),
+            [](KeyedElement const& lhs, KeyedElement const& rhs) {
+              return lhs.first < rhs.first;
+            });
+
+  for (KeyedElement const& keyed : elems) {
+    std::string const& key = keyed.first;
+    Json::Value const& elem = *keyed.second;
+    cmStateEnums::CacheEntryType const type =
+      cmState::StringToCacheEntryType(elem["type"].asString());
+    std::string const value = elem["value"].asString();
+    Json::Value const& properties = elem["properties"];
+
+    // Entries that are never shown stay out of the main table.
+    if (cmState::IsHiddenType(type)) {
+      std::size_t const index = state.AddHiddenCacheEntry(key, type, value);
+      for (auto it = properties.begin(); it != properties.end(); ++it) {
+        if (it->isConvertibleTo(Json::stringValue)) {
+          state.SetHiddenCacheEntryProperty(index, it.name(), it->asString());
+        }
+      }
+      continue;
+    }
+
+    cmState::EntryId const id = state.AddCacheEntry(key, type, value);
+    for (auto it = properties.begin(); it != properties.end(); ++it) {
+      if (!it->isConvertibleTo(Json::stringValue)) {
+        continue;
+      }
+      // The type and value come with the entry.  The MODIFIED property
+      // of cmake is not the flag of edits that were not sent yet.
+      std::string const name = it.name();
+      cmStateEnums::CacheEntryProperty const property =
+        cmState::StringToCacheEntryProperty(name);
+      if (property == cmStateEnums::MODIFIED ||
+          property == cmStateEnums::TYPE || property == cmStateEnums::VALUE) {
+        continue;
+      }
+      state.SetCacheEntryProperty(id, name, it->asString());
+    }
   }
 }
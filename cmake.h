@@ -3,6 +3,8 @@
 #ifndef cmake_h
 #define cmake_h
 
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -10,6 +12,9 @@
 #include <json/value.h>
 #include <uv.h>
 
+#include "cmConfigureProfiler.h"
+#include "cmSessionMetrics.h"
+
 class cmState;
 struct cmDocumentationEntry;
 
@@ -31,9 +36,14 @@ public:
   void SetArgs(std::vector<std::string> const& args);
   void SetDirectoriesFromFile(std::string const& arg);
 
-  int Configure();
+  // Unless waitForCache is false, also wait for the new cache.  Else
+  // IsLoadingCache() is true until it is published, which happens on
+  // the loop and is reported by the cache callback.
+  int Configure(bool waitForCache = true);
   int Generate();
 
+  bool IsLoadingCache() const { return this->CacheLoading; }
+
   void ReadData(const char* data, ssize_t len);
 
 public:
@@ -44,6 +54,13 @@ public:
     this->ProgressUserData = clientData;
   }
 
+  typedef void (*CacheCallbackType)(void*);
+  void SetCacheCallback(CacheCallbackType callback, void* clientData)
+  {
+    this->CacheCallback = callback;
+    this->CacheUserData = clientData;
+  }
+
   void SetHomeDirectory(std::string const& dir)
   {
     this->SourceDirectory = dir;
@@ -61,6 +78,10 @@ public:
 
   cmState* GetState() { return this->State.get(); }
 
+  cmConfigureProfiler const& GetProfiler() const { return this->Profiler; }
+
+  cmSessionMetrics& GetMetrics() { return this->Metrics; }
+
   int DoPreConfigureChecks() { return 0; }
   int LoadCache() { return 0; }
   void AddCMakePaths() {}
@@ -72,7 +93,25 @@ public:
   void UnwatchUnusedCli(const std::string& var) {}
 
 private:
+  // A reply to the cache request, parsed and turned into a new state on
+  // a worker thread.
+  struct CacheIngest;
+
+  // A response that arrived while an ingestion was in progress.
+  struct PendingResponse
+  {
+    std::string Text;
+    std::uint64_t ArrivalTime;
+  };
+
+  void DispatchResponse(std::string response);
   void HandleResponse(std::string const& str);
+  void HandleValue(Json::Value const& value);
+
+  void StartIngest(std::string response);
+  void FinishIngest();
+  static void IngestWork(uv_work_t* req);
+  static void IngestDone(uv_work_t* req, int status);
 
   void HandleHello(Json::Value const& data);
   void HandleReply(std::string const& type, Json::Value const& data);
@@ -80,11 +119,13 @@ private:
   void HandleMessage(Json::Value const& data);
   void HandleProgress(Json::Value const& data);
   void HandleSignal(Json::Value const& data);
+  void FinishCacheLoad();
 
-  void SendRequest(
-    std::string const& type, Json::Value extra = Json::objectValue);
+  // Unless wait is false, runs the loop until the reply is handled.
+  void SendRequest(std::string const& type,
+                   Json::Value extra = Json::objectValue, bool wait = true);
 
-  void ReadCache(Json::Value const& json);
+  static void ReadCache(cmState& state, Json::Value const& json);
 
 private:
   std::string SourceDirectory;
@@ -98,13 +139,27 @@ private:
   ProgressCallbackType ProgressCallback;
   void* ProgressUserData = nullptr;
 
+  bool CacheLoading = false;
+  CacheCallbackType CacheCallback = nullptr;
+  void* CacheUserData = nullptr;
+
   Json::Value CacheArguments = Json::arrayValue;
 
   std::unique_ptr<cmState> State;
 
-  std::string ExpectedReply;
+  cmConfigureProfiler Profiler;
+  cmSessionMetrics Metrics;
+  std::uint64_t ArrivalTime = 0; // when the data being handled was read
+  std::uint64_t RequestTime = 0; // when the last request was sent
+
+  std::string ExpectedReply = "hello"; // sent unasked on startup
   std::string RawReadBuffer;
   std::string RequestBuffer;
+
+  // The ingestion in progress, and the responses that arrived after it
+  // and are handled once it is published, in order.
+  std::unique_ptr<CacheIngest> Ingest;
+  std::deque<PendingResponse> PendingResponses;
 };
 
 #endif